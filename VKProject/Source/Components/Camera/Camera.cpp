@@ -12,15 +12,36 @@ glm::mat4 Camera::GetViewMatrix()
 
 void Camera::ProcessKeyboard(GLFWwindow* window, float deltaTime)
 {
-    float velocity = MovementSpeed * deltaTime;
+    ProcessMovement(ReadMovementKeys(window), deltaTime);
+}
+
+uint8_t Camera::ReadMovementKeys(GLFWwindow* window)
+{
+    uint8_t movement = 0;
 
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        Position += Front * velocity;
+        movement |= MoveForward;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        Position -= Front * velocity;
+        movement |= MoveBackward;
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        Position -= Right * velocity;
+        movement |= MoveLeft;
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        movement |= MoveRight;
+
+    return movement;
+}
+
+void Camera::ProcessMovement(uint8_t movement, float deltaTime)
+{
+    float velocity = MovementSpeed * deltaTime;
+
+    if (movement & MoveForward)
+        Position += Front * velocity;
+    if (movement & MoveBackward)
+        Position -= Front * velocity;
+    if (movement & MoveLeft)
+        Position -= Right * velocity;
+    if (movement & MoveRight)
         Position += Right * velocity;
 }
 
@@ -56,6 +77,15 @@ void Camera::ProcessMouseMovement(double xpos, double ypos, float& lastX, float&
     updateCameraVectors();
 }
 
+void Camera::SetPose(const glm::vec3& position, float yaw, float pitch)
+{
+    Position = position;
+    Yaw = yaw;
+    Pitch = pitch;
+
+    updateCameraVectors();
+}
+
 void Camera::updateCameraVectors()
 {
     glm::vec3 front;
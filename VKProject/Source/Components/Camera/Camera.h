@@ -8,6 +8,14 @@
 
 #include <GLFW/glfw3.h>
 
+enum CameraMovement : uint8_t
+{
+    MoveForward = 1 << 0,
+    MoveBackward = 1 << 1,
+    MoveLeft = 1 << 2,
+    MoveRight = 1 << 3
+};
+
 class Camera
 {
 public:
@@ -16,7 +24,10 @@ public:
     glm::mat4 GetViewMatrix();
 
     void ProcessKeyboard(GLFWwindow* window, float deltaTime);
+    void ProcessMovement(uint8_t movement, float deltaTime);
+    static uint8_t ReadMovementKeys(GLFWwindow* window);
     void ProcessMouseMovement(double xpos, double ypos, float& lastX, float& lastY, bool constrainPitch = true);
+    void SetPose(const glm::vec3& position, float yaw, float pitch);
 
 public:
     glm::vec3 Position = glm::vec3(0.0f, 1.0f, 2.0f);
@@ -0,0 +1,99 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+void CameraPath::writeDefault(const std::string& fileName)
+{
+    std::ofstream file(fileName);
+
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open file! (" + fileName + ")");
+
+    file << "# time x y z yaw pitch\n";
+    file << std::fixed << std::setprecision(4);
+
+    // One turn around the origin in eight seconds, always facing the model.
+    const float radius = 2.0f;
+    const float height = 1.0f;
+    const float pitch = glm::degrees(std::atan(-height / radius));
+
+    for (int i = 0; i <= 8; i++)
+    {
+        float angle = 90.0f + 45.0f * i;
+        float x = radius * std::cos(glm::radians(angle));
+        float z = radius * std::sin(glm::radians(angle));
+
+        file << static_cast<float>(i) << ' ' << x << ' ' << height << ' ' << z << ' ' << angle - 180.0f << ' ' << pitch << '\n';
+    }
+}
+
+void CameraPath::Load(const std::string& fileName)
+{
+    std::ifstream file(fileName);
+
+    if (!file.is_open())
+    {
+        writeDefault(fileName);
+        file.open(fileName);
+
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open file! (" + fileName + ")");
+    }
+
+    mKeys.clear();
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream values(line);
+        CameraKey key{};
+
+        if (!(values >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch))
+            throw std::runtime_error("Invalid camera path line! (" + line + ")");
+
+        mKeys.push_back(key);
+    }
+
+    if (mKeys.empty())
+        throw std::runtime_error("Camera path has no keys! (" + fileName + ")");
+
+    std::stable_sort(mKeys.begin(), mKeys.end(), [](const CameraKey& a, const CameraKey& b) { return a.time < b.time; });
+
+    std::cout << "Camera path " << fileName << ": " << mKeys.size() << " keys, " << GetDuration() << " s\n";
+}
+
+CameraKey CameraPath::Sample(float time) const
+{
+    if (mKeys.size() == 1 || GetDuration() <= 0.0f)
+        return mKeys.front();
+
+    time = std::fmod(time, GetDuration());
+
+    auto next = std::upper_bound(mKeys.begin(), mKeys.end(), time, [](float t, const CameraKey& key) { return t < key.time; });
+
+    if (next == mKeys.begin())
+        return mKeys.front();
+    if (next == mKeys.end())
+        return mKeys.back();
+
+    const CameraKey& a = *(next - 1);
+    const CameraKey& b = *next;
+    float t = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0.0f;
+
+    CameraKey key;
+    key.time = time;
+    key.position = glm::mix(a.position, b.position, t);
+    key.yaw = a.yaw + (b.yaw - a.yaw) * t;
+    key.pitch = a.pitch + (b.pitch - a.pitch) * t;
+
+    return key;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+struct CameraKey
+{
+    float time;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+// Camera keyframes for benchmark runs, one "time x y z yaw pitch" per line. Lines starting with # are comments.
+// A missing file is created with an orbit around the model, like user.cfg.
+class CameraPath
+{
+public:
+    void Load(const std::string& fileName);
+
+    // Linear between keys; the path loops once the last key is passed.
+    CameraKey Sample(float time) const;
+
+    float GetDuration() const { return mKeys.empty() ? 0.0f : mKeys.back().time; }
+    size_t GetKeyCount() const { return mKeys.size(); }
+
+private:
+    void writeDefault(const std::string& fileName);
+
+    std::vector<CameraKey> mKeys;
+};
+
+#endif
\ No newline at end of file
@@ -11,42 +11,35 @@
 #include <fstream>
 
 #include <Core/CfgParser.h>
+#include <Core/Memory/AllocationCounter.h>
+#include <Core/Profiling/Profiler.h>
+#include <Core/Profiling/StartupTrace.h>
 
-Application::Application()
+Application::Application(const std::map<std::string, uint32_t>& overrides, const std::map<std::string, std::string>& files)
 {
 	CfgParser cfgs;
-	std::string configs = cfgs.GetConfigs();
-	std::string temp = configs;
-	std::string line = configs;
-	
-	std::vector<std::string> cfgList;
+	mConfigs = cfgs.GetValues();
 
-	line.erase(line.find("\n"), line.find("\0") + line.size());
-	cfgList.push_back(line);
+	for (const auto& value : overrides)
+		mConfigs[value.first] = value.second;
 
-	for (size_t i = 0; i < 3; i++)
-	{
-		temp.erase(0, line.size() + 1);
-		temp.erase(temp.find("\n"), temp.find("\0") + temp.size());
-		cfgList.push_back(temp);
-		line += "\n";
-		line += temp;
+	// VKPROJECT_TRACE=1 or VKPROJECT_TRACE=<file> turns tracing on without touching user.cfg.
+	std::string traceFile = CfgParser::GetEnvironment("VKPROJECT_TRACE");
+	if (mConfigs["TRACE_STARTUP"] || !traceFile.empty())
+		StartupTrace::Get().Enable(traceFile.empty() || traceFile == "1" ? "startup_trace.json" : traceFile);
 
-		temp = configs;
+	// VKPROJECT_PROFILE works the same way for the zone profiler; PROFILER=2 keeps the live panel without a trace file.
+	std::string profileFile = CfgParser::GetEnvironment("VKPROJECT_PROFILE");
+	if (mConfigs["PROFILER"] || !profileFile.empty())
+	{
+		Profiler::Get().SetThreadName("Main");
+		Profiler::Get().Start(mConfigs["PROFILER"] == 2 ? "" : profileFile.empty() || profileFile == "1" ? "profile_trace.json" : profileFile);
 	}
 
 	std::cout << "Graphics Settings:\n";
 
-	for (auto cfg : cfgList)
-	{
-		temp = cfg;
-		cfg.erase(0, cfg.find("=") + 1);
-		temp.erase(temp.find("="), temp.find("=") + cfg.size());
-
-		mConfigs[temp] = atoi(cfg.c_str());
-
-		std::cout << temp << "=" << cfg << '\n';
-	}
+	for (const auto& cfg : mConfigs)
+		std::cout << cfg.first << "=" << cfg.second << '\n';
 
 	mMipMapsEnable = mConfigs["MIPMAPS"];
 	mSampleRateShadingEnable = mConfigs["SAMPLE_RATE_SHADING"];
@@ -80,21 +73,201 @@ Application::Application()
 		break;
 	}
 	mAnisatropyLevel = mConfigs["ANISOTROPY"];
+
+	if (mConfigs["FRAMES_IN_FLIGHT"] > 0)
+		mFramesInFlight = std::min<uint32_t>(mConfigs["FRAMES_IN_FLIGHT"], 4);
+
+	mPresentModeSetting = mConfigs["PRESENT_MODE"];
+	mMaxQueuedFrames = mConfigs["MAX_QUEUED_FRAMES"] > 0 ? std::min(mConfigs["MAX_QUEUED_FRAMES"], mFramesInFlight) : mFramesInFlight;
+	mFramePacer.SetFrameRateLimit(mConfigs["FPS_LIMIT"]);
+	mLowLatency = mConfigs["LOW_LATENCY"];
+
+	mRenderThreadEnabled = mConfigs["RENDER_THREAD"];
+	mSubmitThreadEnabled = mConfigs["SUBMIT_THREAD"];
+	mInputRate = mConfigs["INPUT_RATE"] > 0 ? mConfigs["INPUT_RATE"] : 240;
+
+	uint32_t jobWorkers = mConfigs["JOB_WORKERS"];
+	if (jobWorkers == 0)
+		jobWorkers = std::max(1u, std::thread::hardware_concurrency());
+
+	mJobs = std::make_unique<JobSystem>(std::min<uint32_t>(jobWorkers, 16));
+
+	mParallelAssetLoading = mConfigs["PARALLEL_ASSET_LOADING"];
+
+	mHeadless = mConfigs["HEADLESS"];
+	mHeadlessFrames = mConfigs["HEADLESS_FRAMES"] > 0 ? mConfigs["HEADLESS_FRAMES"] : 300;
+
+	if (mHeadless)
+		mFrameLimit = mHeadlessFrames;
+
+	auto file = [&files](const char* name, const char* fallback)
+	{
+		auto it = files.find(name);
+		return it != files.end() ? it->second : std::string(fallback);
+	};
+
+	if (files.count("REPLAY_INPUT"))
+	{
+		mInputReplay.Load(file("REPLAY_INPUT", ""));
+		mBenchmark = true;
+	}
+	else
+	{
+		mBenchmark = mConfigs["BENCHMARK"];
+	}
+
+	if (files.count("RECORD_INPUT") && !mBenchmark && !mHeadless)
+		mInputRecorder.Open(file("RECORD_INPUT", ""));
+
+	if (mBenchmark)
+	{
+		uint32_t warmupFrames = mConfigs["BENCHMARK_WARMUP"];
+		uint32_t benchmarkFrames = mConfigs["BENCHMARK_FRAMES"] > 0 ? mConfigs["BENCHMARK_FRAMES"] : 1000;
+
+		if (mInputReplay.IsLoaded())
+		{
+			benchmarkFrames = mInputReplay.GetFrameCount() > warmupFrames ? mInputReplay.GetFrameCount() - warmupFrames : 0;
+			mBenchmarkInput = "replay:" + file("REPLAY_INPUT", "");
+		}
+		else
+		{
+			mCameraPathFile = file("CAMERA_PATH", "camera.path");
+			mCameraPath.Load(mCameraPathFile);
+			mBenchmarkInput = "path:" + mCameraPathFile;
+		}
+
+		mFrameLimit = warmupFrames + benchmarkFrames;
+		mBenchmarkReport = BenchmarkReport(warmupFrames);
+
+		std::cout << "Benchmark: " << warmupFrames << " warmup and " << benchmarkFrames << " measured frames from " << mBenchmarkInput << '\n';
+	}
+
+	// Benchmarks step the camera once per rendered frame to stay deterministic, and headless runs have no input.
+	if (mRenderThreadEnabled && (mBenchmark || mHeadless))
+	{
+		std::cout << "RENDER_THREAD is ignored for benchmark and headless runs\n";
+		mRenderThreadEnabled = false;
+	}
+
+	if (mConfigs["FRAME_STATS_CSV"])
+		mFrameStatistics.OpenCsv("frame_stats.csv");
+
+	switch (mConfigs["HOST_ALLOCATOR"])
+	{
+	case 1:
+		HostAllocator::Get().SetMode(HostAllocatorMode::Tracking);
+		break;
+	case 2:
+		HostAllocator::Get().SetMode(HostAllocatorMode::Pooled);
+		break;
+	default:
+		HostAllocator::Get().SetMode(HostAllocatorMode::Disabled);
+		break;
+	}
+	mAllocator = HostAllocator::Get().Callbacks();
 }
 
 Application::~Application()
 {
+	// Loading jobs write into this object; they have to be done before it goes away.
+	mJobs->Wait(mModelLoaded);
+	mJobs->Wait(mTextureDecoded);
+
+	if (mTexturePixels)
+		stbi_image_free(mTexturePixels);
+
+	// Still running if the frame loop threw; the queues have to be ours again before the device is idled.
+	mSubmission.Stop();
+
+	// Members, the deletion queue and transient memory are destroyed after this, possibly with frames still executing.
+	if (mDevice != VK_NULL_HANDLE)
+		vkDeviceWaitIdle(mDevice);
+
+	if (ImGui::GetCurrentContext())
+	{
+		ImGui_ImplVulkan_Shutdown();
+		ImGui_ImplGlfw_Shutdown();
+		ImGui::DestroyContext();
+	}
+}
+
+void Application::startAssetLoading()
+{
+	if (!mParallelAssetLoading)
+		return;
+
+	mJobs->Run([this]
+	{
+		try
+		{
+			loadModel();
+		}
+		catch (...)
+		{
+			mModelError = std::current_exception();
+		}
+	}, &mModelLoaded);
+
+	mJobs->Run([this]
+	{
+		try
+		{
+			decodeTexture();
+		}
+		catch (...)
+		{
+			mTextureError = std::current_exception();
+		}
+	}, &mTextureDecoded);
+}
+
+void Application::waitForAsset(JobCounter& counter, std::exception_ptr& error)
+{
+	TRACE_SCOPE("waitForAsset");
+
+	mJobs->Wait(counter);
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+void Application::printStartupTime()
+{
+	auto now = std::chrono::steady_clock::now();
+	double startup = std::chrono::duration<double, std::milli>(now - mRunStart).count();
+
+	StartupTrace::Get().Record("Startup", mRunStart, now);
+	StartupTrace::Get().Finish();
+
+	std::cout << "Startup took " << startup << " ms (" << (mParallelAssetLoading ? "parallel" : "sequential") << " asset loading)\n";
+}
+
+void Application::decodeTexture()
+{
+	TRACE_SCOPE("decodeTexture");
+
+	int texChannels;
+	mTexturePixels = stbi_load(TEXTURE_PATH.c_str(), &mTextureWidth, &mTextureHeight, &texChannels, STBI_rgb_alpha);
+
+	if (!mTexturePixels)
+		throw std::runtime_error("Failed to load texture image!");
 }
 
 void Application::loadModel()
 {
+	TRACE_SCOPE("loadModel");
+
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
 	std::vector<tinyobj::material_t> materials;
 	std::string warn, err;
 
-	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, MODEL_PATH.c_str())) {
-		throw std::runtime_error(warn + err);
+	{
+		TRACE_SCOPE("tinyobj::LoadObj");
+
+		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, MODEL_PATH.c_str())) {
+			throw std::runtime_error(warn + err);
+		}
 	}
 
 	std::unordered_map<Vertex, uint32_t> uniqueVertices{};
@@ -143,6 +316,8 @@ void Application::loadModel()
 
 void Application::createInstance()
 {
+	TRACE_SCOPE("createInstance");
+
 	if (mEnableValidationLayers && !checkValidationLayerSupport())
 		throw std::runtime_error("Validation layers requested, but not available!");
 
@@ -171,18 +346,45 @@ void Application::createInstance()
 		createInfo.enabledLayerCount = 0;
 	}
 
-	if (vkCreateInstance(&createInfo, nullptr, mInstance.replace()) != VK_SUCCESS)
+	if (vkCreateInstance(&createInfo, mAllocator, mInstance.replace()) != VK_SUCCESS)
 		throw std::runtime_error("failed to create instance!");
 }
 
+void Application::buildDrawList()
+{
+	TRACE_SCOPE("buildDrawList");
+
+	// The model is a single mesh, so DRAW_COUNT splits its triangles into that many draws to stress command recording.
+	uint32_t triangleCount = static_cast<uint32_t>(mIndices.size() / 3);
+	uint32_t drawCount = std::min(std::max(mConfigs["DRAW_COUNT"], 1u), std::max(triangleCount, 1u));
+
+	mDrawList.clear();
+	mDrawList.reserve(drawCount);
+
+	for (uint32_t i = 0; i < drawCount; i++)
+	{
+		uint32_t firstTriangle = static_cast<uint32_t>(static_cast<uint64_t>(triangleCount) * i / drawCount);
+		uint32_t lastTriangle = static_cast<uint32_t>(static_cast<uint64_t>(triangleCount) * (i + 1) / drawCount);
+
+		uint32_t variant = mConfigs["PIPELINE_VARIANTS"] > 0 ? i % mConfigs["PIPELINE_VARIANTS"] : UINT32_MAX;
+		mDrawList.push_back({ firstTriangle * 3, (lastTriangle - firstTriangle) * 3, variant });
+	}
+
+	std::cout << "Draw list: " << mDrawList.size() << " draws recorded on " << mJobs->GetWorkerCount() << " workers\n";
+}
+
 void Application::createSurface()
 {
-	if (glfwCreateWindowSurface(mInstance, mWindow, nullptr, mSurface.replace()) != VK_SUCCESS)
+	TRACE_SCOPE("createSurface");
+
+	if (glfwCreateWindowSurface(mInstance, mWindow, mAllocator, mSurface.replace(mInstance)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create window surface!");
 }
 
 void Application::pickPhysicalDevice()
 {
+	TRACE_SCOPE("pickPhysicalDevice");
+
 	uint32_t deviceCount = 0;
 	vkEnumeratePhysicalDevices(mInstance, &deviceCount, nullptr);
 
@@ -220,10 +422,24 @@ void Application::pickPhysicalDevice()
 	std::cout << "Max Anisotropy level = " << props.limits.maxSamplerAnisotropy << '\n';
 	std::cout << "Max MSAA level = " << props.limits.framebufferColorSampleCounts << '\n';
 	std::cout << "Max memory usage = " << props.limits.maxMemoryAllocationCount << "Mb" << '\n';
+
+	mMemoryBudgetSupported = checkInstanceExtensionSupport(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) &&
+		checkDeviceExtensionSupport(mPhysDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+	MemoryTracker::Get().Init(mInstance, mPhysDevice, mMemoryBudgetSupported);
+
+	std::cout << "Memory budget = " << (mMemoryBudgetSupported ? "VK_EXT_memory_budget" : "unavailable") << '\n';
+
+	mTimelineSupported = mConfigs["TIMELINE_SEMAPHORES"] && checkInstanceExtensionSupport(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) &&
+		checkDeviceExtensionSupport(mPhysDevice, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) && QueueTimeline::IsSupported(mInstance, mPhysDevice);
+
+	std::cout << "Queue synchronization = " << (mTimelineSupported ? "VK_KHR_timeline_semaphore" : "fences") << '\n';
 }
 
 void Application::createLogicalDevice()
 {
+	TRACE_SCOPE("createLogicalDevice");
+
 	QueueFamilyIndices indices = findQueueFamilies(mPhysDevice);
 
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
@@ -258,12 +474,29 @@ void Application::createLogicalDevice()
 		deviceFeatures.sampleRateShading = VK_FALSE;
 	}
 
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(mPhysDevice, &supportedFeatures);
+	FrameStatistics::EnableFeatures(supportedFeatures, deviceFeatures);
+
+	std::vector<const char*> extensions = getDeviceExtensions();
+	if (mMemoryBudgetSupported)
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR };
+	timelineFeatures.timelineSemaphore = VK_TRUE;
+
 	VkDeviceCreateInfo createInfo{ VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	if (mTimelineSupported)
+	{
+		extensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		createInfo.pNext = &timelineFeatures;
+	}
+
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pEnabledFeatures = &deviceFeatures;
-	createInfo.enabledExtensionCount = mDeviceExtensions.size();
-	createInfo.ppEnabledExtensionNames = mDeviceExtensions.data();
+	createInfo.enabledExtensionCount = extensions.size();
+	createInfo.ppEnabledExtensionNames = extensions.data();
 
 	if (mEnableValidationLayers)
 	{
@@ -275,15 +508,28 @@ void Application::createLogicalDevice()
 		createInfo.enabledLayerCount = 0;
 	}
 
-	if (vkCreateDevice(mPhysDevice, &createInfo, nullptr, mDevice.replace()) != VK_SUCCESS)
+	if (vkCreateDevice(mPhysDevice, &createInfo, mAllocator, mDevice.replace()) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create Logical Device!");
 
 	vkGetDeviceQueue(mDevice, indices.graphicsFamily, 0, &mGraphicsQueue);
 	vkGetDeviceQueue(mDevice, indices.presentFamily, 0, &mPresentQueue);
+
+	mGraphicsTimeline.Init(mTimelineSupported);
+	mGpuProfiler.Init(mPhysDevice, indices.graphicsFamily, mFramesInFlight);
+	mFrameStatistics.Init(deviceFeatures, mFramesInFlight);
+}
+
+void Application::createPipelineCache()
+{
+	TRACE_SCOPE("createPipelineCache");
+
+	mPipelineCache.Load(mPhysDevice, PIPELINE_CACHE_PATH);
 }
 
 void Application::createSwapChain()
 {
+	TRACE_SCOPE("createSwapChain");
+
 	SwapChainSupportDetails swapChainSupport = querySwapChainSupport(mPhysDevice);
 
 	VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -329,10 +575,12 @@ void Application::createSwapChain()
 	createInfo.oldSwapchain = oldSwapChain;
 
 	VkSwapchainKHR newSwapChain;
-	if (vkCreateSwapchainKHR(mDevice, &createInfo, nullptr, &newSwapChain) != VK_SUCCESS)
+	if (vkCreateSwapchainKHR(mDevice, &createInfo, mAllocator, &newSwapChain) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create swap chain!");
 
-	mSwapChain = newSwapChain;
+	// The old swap chain is retired by the create call, but its images may still be queued for presentation.
+	retire(mSwapChain);
+	mSwapChain.reset(mDevice, newSwapChain);
 
 	vkGetSwapchainImagesKHR(mDevice, mSwapChain, &imageCount, nullptr);
 	mSwapChainImages.resize(imageCount);
@@ -342,9 +590,102 @@ void Application::createSwapChain()
 	mSwapChainExtent = extent;
 }
 
+void Application::createOffscreenImages()
+{
+	TRACE_SCOPE("createOffscreenImages");
+
+	mSwapChainImageFormat = VK_FORMAT_B8G8R8A8_UNORM;
+	mSwapChainExtent = { mWIDTH, mHEIGHT };
+
+	mOffscreenImages.resize(mFramesInFlight);
+	mOffscreenImageMemory.resize(mFramesInFlight);
+	mSwapChainImages.resize(mFramesInFlight);
+
+	for (uint32_t i = 0; i < mFramesInFlight; i++)
+	{
+		createImage(mWIDTH, mHEIGHT, mSwapChainImageFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mOffscreenImages[i], mOffscreenImageMemory[i], 1, VK_SAMPLE_COUNT_1_BIT, "Offscreen target");
+
+		mSwapChainImages[i] = mOffscreenImages[i];
+	}
+
+	std::cout << "Headless: rendering " << mHeadlessFrames << " frames into " << mFramesInFlight << " offscreen images of " << mWIDTH << "x" << mHEIGHT << '\n';
+}
+
+void Application::saveOffscreenImage(uint32_t imageIndex, const std::string& fileName)
+{
+	VkDeviceSize size = static_cast<VkDeviceSize>(mSwapChainExtent.width) * mSwapChainExtent.height * 4;
+
+	VkHandle<VkBuffer, DestroyTrackedBuffer> readbackBuffer;
+	VkHandle<VkDeviceMemory, FreeTrackedMemory> readbackBufferMemory;
+
+	createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, readbackBuffer, readbackBufferMemory, "Offscreen readback");
+
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+	// The render pass leaves the image in TRANSFER_SRC_OPTIMAL; only its writes still have to be made visible.
+	VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = mSwapChainImages[imageIndex];
+	barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	VkBufferImageCopy region{};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { mSwapChainExtent.width, mSwapChainExtent.height, 1 };
+
+	vkCmdCopyImageToBuffer(commandBuffer, mSwapChainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1, &region);
+
+	VkMemoryBarrier hostBarrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+
+	endSingleTimeCommands(commandBuffer);
+
+	std::ofstream file(fileName, std::ios::binary);
+
+	if (!file.is_open())
+		throw std::runtime_error("Failed to open file! (" + fileName + ")");
+
+	file << "P6\n" << mSwapChainExtent.width << " " << mSwapChainExtent.height << "\n255\n";
+
+	void* data;
+	vkMapMemory(mDevice, readbackBufferMemory, 0, size, 0, &data);
+
+	const unsigned char* pixels = static_cast<const unsigned char*>(data);
+	std::vector<char> row(mSwapChainExtent.width * 3);
+
+	for (uint32_t y = 0; y < mSwapChainExtent.height; y++)
+	{
+		for (uint32_t x = 0; x < mSwapChainExtent.width; x++)
+		{
+			const unsigned char* bgra = pixels + (static_cast<size_t>(y) * mSwapChainExtent.width + x) * 4;
+			row[x * 3 + 0] = static_cast<char>(bgra[2]);
+			row[x * 3 + 1] = static_cast<char>(bgra[1]);
+			row[x * 3 + 2] = static_cast<char>(bgra[0]);
+		}
+
+		file.write(row.data(), row.size());
+	}
+
+	vkUnmapMemory(mDevice, readbackBufferMemory);
+
+	std::cout << "Headless: last frame written to " << fileName << '\n';
+}
+
 void Application::createImageViews()
 {
-	mSwapChainImageViews.resize(mSwapChainImages.size(), VkDeleter<VkImageView>{mDevice, vkDestroyImageView});
+	TRACE_SCOPE("createImageViews");
+
+	mSwapChainImageViews.resize(mSwapChainImages.size());
 
 	for (uint32_t i = 0; i < mSwapChainImages.size(); i++)
 	{
@@ -370,11 +711,13 @@ VkSampleCountFlagBits Application::getMaxUsableSampleCount()
 
 void Application::createRenderPass()
 {
+	TRACE_SCOPE("createRenderPass");
+
 	VkAttachmentDescription colorAttachment{};
 	colorAttachment.format = mSwapChainImageFormat;
 	colorAttachment.samples = mMSAASamples;
 	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -398,7 +741,8 @@ void Application::createRenderPass()
 	colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	// Offscreen images are left ready to be copied out; PRESENT_SRC_KHR needs VK_KHR_swapchain.
+	colorAttachmentResolve.finalLayout = mHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 	VkAttachmentReference colorAttachmentRef{};
 	colorAttachmentRef.attachment = 0;
@@ -436,13 +780,15 @@ void Application::createRenderPass()
 	renderPassInfo.dependencyCount = 1;
 	renderPassInfo.pDependencies = &dependency;
 
-	if (vkCreateRenderPass(mDevice, &renderPassInfo, nullptr, mRenderPass.replace()) != VK_SUCCESS) {
+	if (vkCreateRenderPass(mDevice, &renderPassInfo, mAllocator, mRenderPass.replace(mDevice)) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create render pass!");
 	}
 }
 
 void Application::createDescriptorSetLayout()
 {
+	TRACE_SCOPE("createDescriptorSetLayout");
+
 	VkDescriptorSetLayoutBinding uboLayoutBinding{};
 	uboLayoutBinding.binding = 0;
 	uboLayoutBinding.descriptorCount = 1;
@@ -463,28 +809,89 @@ void Application::createDescriptorSetLayout()
 	layoutInfo.bindingCount = bindings.size();
 	layoutInfo.pBindings = bindings.data();
 
-	if (vkCreateDescriptorSetLayout(mDevice, &layoutInfo, nullptr, mDescriptorSetLayout.replace()) != VK_SUCCESS)
+	if (vkCreateDescriptorSetLayout(mDevice, &layoutInfo, mAllocator, mDescriptorSetLayout.replace(mDevice)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create descriptor set layout!");
 }
 
 void Application::createGraphicsPipeline()
 {
-	auto vertShaderCode = readFile("Shaders/vert.spv");
-	auto fragShaderCode = readFile("Shaders/frag.spv");
+	TRACE_SCOPE("createGraphicsPipeline");
+
+	if (mVertShaderModule == VK_NULL_HANDLE)
+	{
+		createShaderModule(readFile("Shaders/vert.spv"), mVertShaderModule);
+		createShaderModule(readFile("Shaders/frag.spv"), mFragShaderModule);
+	}
+
+	if (mPipelineLayout == VK_NULL_HANDLE)
+	{
+		VkDescriptorSetLayout setLayouts[] = { mDescriptorSetLayout };
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = setLayouts;
+
+		if (vkCreatePipelineLayout(mDevice, &pipelineLayoutInfo, mAllocator, mPipelineLayout.replace(mDevice)) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create pipeline layout!");
+	}
+
+	// The default variant is compiled up front; it is the fallback for every draw whose permutation is not ready yet.
+	double start = getTime();
+
+	mGraphicsPipeline.reset(mDevice, buildGraphicsPipeline(PipelineVariant{}));
+
+	if (mGraphicsPipeline == VK_NULL_HANDLE)
+		throw std::runtime_error("Failed to create graphics pipeline!");
+
+	std::cout << "Graphics pipeline created in " << (getTime() - start) * 1000.0 << " ms (" << (mPipelineCache.IsWarm() ? "warm" : "cold") << " pipeline cache)\n";
+}
+
+void Application::requestPipelineVariants()
+{
+	TRACE_SCOPE("requestPipelineVariants");
+
+	uint32_t variantCount = mConfigs["PIPELINE_VARIANTS"];
+
+	mPipelineVariants.clear();
+	mPipelineHandles.clear();
+
+	for (uint32_t i = 0; i < variantCount; i++)
+	{
+		PipelineVariant variant;
+		variant.cullMode = i & 1 ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
+		variant.depthCompareOp = i & 2 ? VK_COMPARE_OP_LESS_OR_EQUAL : VK_COMPARE_OP_LESS;
+		variant.minSampleShading = std::min(0.2f + 0.1f * (i >> 2), 1.0f);
+
+		mPipelineVariants.push_back(variant);
+		mPipelineHandles.push_back(mPipelines->Request("Scene variant " + std::to_string(i), [this, variant] { return buildGraphicsPipeline(variant); }));
+	}
+
+	mPipelines->Seal();
+
+	mResolvedPipelines.resize(variantCount);
+}
+
+void Application::resolvePipelines()
+{
+	PROFILE_ZONE("resolvePipelines");
 
-	VkDeleter<VkShaderModule> vertShaderModule{ mDevice, vkDestroyShaderModule };
-	VkDeleter<VkShaderModule> fragShaderModule{ mDevice, vkDestroyShaderModule };
-	createShaderModule(vertShaderCode, vertShaderModule);
-	createShaderModule(fragShaderCode, fragShaderModule);
+	for (size_t i = 0; i < mPipelineHandles.size(); i++)
+	{
+		VkPipeline pipeline = mPipelines->Get(mPipelineHandles[i]);
+		mResolvedPipelines[i] = pipeline != VK_NULL_HANDLE ? pipeline : static_cast<VkPipeline>(mGraphicsPipeline);
+	}
+}
 
+VkPipeline Application::buildGraphicsPipeline(const PipelineVariant& variant)
+{
+	// Runs on pipeline compile jobs: only reads state that stays fixed while pipelines are being compiled.
 	VkPipelineShaderStageCreateInfo vertShaderStageInfo{ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
 	vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageInfo.module = vertShaderModule;
+	vertShaderStageInfo.module = mVertShaderModule;
 	vertShaderStageInfo.pName = "main";
 
 	VkPipelineShaderStageCreateInfo fragShaderStageInfo{ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
 	fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageInfo.module = fragShaderModule;
+	fragShaderStageInfo.module = mFragShaderModule;
 	fragShaderStageInfo.pName = "main";
 
 	VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
@@ -503,37 +910,29 @@ void Application::createGraphicsPipeline()
 	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-	VkViewport viewport = {};
-	viewport.x = 0.0f;
-	viewport.y = 0.0f;
-	viewport.width = static_cast<float>(mSwapChainExtent.width);
-	viewport.height = static_cast<float>(mSwapChainExtent.height);
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
-
-	VkRect2D scissor = {};
-	scissor.offset = { 0, 0 };
-	scissor.extent = mSwapChainExtent;
-
 	VkPipelineViewportStateCreateInfo viewportState{ VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
 	viewportState.viewportCount = 1;
-	viewportState.pViewports = &viewport;
 	viewportState.scissorCount = 1;
-	viewportState.pScissors = &scissor;
+
+	std::array<VkDynamicState, 2> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+	VkPipelineDynamicStateCreateInfo dynamicState{ VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+	dynamicState.pDynamicStates = dynamicStates.data();
 
 	VkPipelineRasterizationStateCreateInfo rasterizer{ VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
 	rasterizer.depthClampEnable = VK_FALSE;
 	rasterizer.rasterizerDiscardEnable = VK_FALSE;
 	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
 	rasterizer.lineWidth = 1.0f;
-	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+	rasterizer.cullMode = variant.cullMode;
 	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
 	rasterizer.depthBiasEnable = VK_FALSE;
 
 	VkPipelineMultisampleStateCreateInfo multisampling{ VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
 	multisampling.sampleShadingEnable = VK_TRUE;
 	multisampling.rasterizationSamples = mMSAASamples;
-	multisampling.minSampleShading = .2f;
+	multisampling.minSampleShading = variant.minSampleShading;
 
 	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
 	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -547,18 +946,10 @@ void Application::createGraphicsPipeline()
 	for (size_t i = 0; i < 3; i++)
 		colorBlending.blendConstants[i] = 0.0f;
 
-	VkDescriptorSetLayout setLayouts[] = { mDescriptorSetLayout };
-	VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
-	pipelineLayoutInfo.setLayoutCount = 1;
-	pipelineLayoutInfo.pSetLayouts = setLayouts;
-
-	if (vkCreatePipelineLayout(mDevice, &pipelineLayoutInfo, nullptr, mPipelineLayout.replace()) != VK_SUCCESS)
-		throw std::runtime_error("Failed to create pipeline layout!");
-
 	VkPipelineDepthStencilStateCreateInfo depthStencil{ VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
 	depthStencil.depthTestEnable = VK_TRUE;
 	depthStencil.depthWriteEnable = VK_TRUE;
-	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+	depthStencil.depthCompareOp = variant.depthCompareOp;
 	depthStencil.depthBoundsTestEnable = VK_FALSE;
 	depthStencil.minDepthBounds = 0.0f;
 	depthStencil.maxDepthBounds = 1.0f;
@@ -576,49 +967,108 @@ void Application::createGraphicsPipeline()
 	pipelineInfo.pMultisampleState = &multisampling;
 	pipelineInfo.pDepthStencilState = &depthStencil;
 	pipelineInfo.pColorBlendState = &colorBlending;
+	pipelineInfo.pDynamicState = &dynamicState;
 	pipelineInfo.layout = mPipelineLayout;
 	pipelineInfo.renderPass = mRenderPass;
 	pipelineInfo.subpass = 0;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-	if (vkCreateGraphicsPipelines(mDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, mGraphicsPipeline.replace()) != VK_SUCCESS)
-		throw std::runtime_error("Failed to create graphics pipeline!");
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	if (vkCreateGraphicsPipelines(mDevice, mPipelineCache, 1, &pipelineInfo, mAllocator, &pipeline) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	return pipeline;
 }
 
 void Application::initVulkan()
 {
 	createInstance();
 	setupDebugCallback();
-	createSurface();
+	if (!mHeadless)
+		createSurface();
 	pickPhysicalDevice();
 	createLogicalDevice();
-	createSwapChain();
+	createPipelineCache();
+	if (mHeadless)
+		createOffscreenImages();
+	else
+		createSwapChain();
 	createImageViews();
 	createRenderPass();
 	createDescriptorSetLayout();
 	createGraphicsPipeline();
+	mPipelines = std::make_unique<PipelineManager>(mDevice, *mJobs);
+	requestPipelineVariants();
 	createCommandPool();
+	createFrameResources();
 	createColorResources();
 	createDepthResources();
+	createTransientResources();
 	createFramebuffers();
 	createTextureImage();
 	createTextureImageView();
 	createTextureSampler();
-	loadModel();
+	if (mParallelAssetLoading)
+		waitForAsset(mModelLoaded, mModelError);
+	else
+		loadModel();
+
+	buildDrawList();
 	createVertexBuffer();
 	createIndexBuffer();
 	createUniformBuffer();
 	createDescriptorPool();
-	createDescriptorSet();
+	createDescriptorSets();
 	createCommandBuffers();
-	createSemaphores();
-	InitImGui();
+	if (!mHeadless)
+		InitImGui();
 }
 
 void Application::drawScene()
 {
-	uint32_t imageIndex;
-	VkResult result = vkAcquireNextImageKHR(mDevice, mSwapChain, std::numeric_limits<uint64_t>::max(), mImageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+	PROFILE_ZONE("drawScene");
+
+	FrameData& frame = *mFrames[mCurrentFrame];
+
+	collectLatency();
+
+	// The render thread's equivalent of polling input: take the newest simulation tick.
+	if (mRenderThreadEnabled && !mLowLatency)
+		mSnapshots.Update();
+
+	double waitStart = getTime();
+
+	// With fewer queued frames than frames in flight, wait for a newer frame than the one that last used this slot.
+	// Submissions to one queue complete in order, so the newer of the two values covers both.
+	{
+		PROFILE_ZONE("Wait for frame slot");
+		mGraphicsTimeline.Wait(std::max(frame.timelineValue, mFrames[(mCurrentFrame + mFramesInFlight - mMaxQueuedFrames) % mFramesInFlight]->timelineValue));
+	}
+
+	double acquireStart = getTime();
+	mFenceWaitTime = static_cast<float>(acquireStart - waitStart);
+
+	collectLatency();
+
+	mDeletionQueue.Flush(mGraphicsTimeline.GetCompleted());
+
+	uint32_t imageIndex = 0;
+	VkResult result = VK_SUCCESS;
+	if (mHeadless)
+	{
+		// One offscreen image per frame in flight, so the wait above already guarantees this one is free.
+		imageIndex = static_cast<uint32_t>(mFrameNumber % mSwapChainImages.size());
+	}
+	else
+	{
+		PROFILE_ZONE("vkAcquireNextImageKHR");
+		if (mSubmission.IsRunning())
+			result = mSubmission.AcquireNextImage(mSwapChain, frame.imageAvailable, imageIndex);
+		else
+			result = vkAcquireNextImageKHR(mDevice, mSwapChain, std::numeric_limits<uint64_t>::max(), frame.imageAvailable, VK_NULL_HANDLE, &imageIndex);
+	}
+
+	mAcquireWaitTime = static_cast<float>(getTime() - acquireStart);
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR)
 	{
@@ -630,84 +1080,377 @@ void Application::drawScene()
 		throw std::runtime_error("failed to acquire swap chain image!");
 	}
 
-	VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-
-	VkSemaphore waitSemaphores[] = { mImageAvailableSemaphore };
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
-
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &mCommandBuffers[imageIndex];
+	frame.arena.Reset();
 
-	VkSemaphore signalSemaphores[] = { mRenderFinishedSemaphore };
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = signalSemaphores;
+	double jobsStart = getTime();
 
-	VkResult res = vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	// GLFW input and ImGui must stay on the main thread; the uniform update waits for the camera, recording does not.
+	JobCounter inputDone;
+	JobCounter frameJobs;
 
-	if (res != VK_SUCCESS)
-		throw std::runtime_error("failed to submit draw command buffer!");
+	resolvePipelines();
 
-	VkPresentInfoKHR presentInfo{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
-	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = signalSemaphores;
+	if (!mLowLatency)
+	{
+		if (!mRenderThreadEnabled)
+			mJobs->Run([this] { updateCamera(deltaTime); }, &inputDone, JobAffinity::MainThread);
 
-	VkSwapchainKHR swapChains[] = { mSwapChain };
-	presentInfo.swapchainCount = 1;
-	presentInfo.pSwapchains = swapChains;
+		mJobs->Run([this, &frame] { updateUniformBuffer(frame); }, &frameJobs, JobAffinity::Any, &inputDone);
+	}
 
-	presentInfo.pImageIndices = &imageIndex;
+	for (uint32_t batch = 0; batch < frame.secondaryBuffers.size(); batch++)
+		mJobs->Run([this, &frame, batch, imageIndex] { recordDraws(frame, batch, imageIndex); }, &frameJobs);
 
-	result = vkQueuePresentKHR(mPresentQueue, &presentInfo);
+	if (!mHeadless)
+		mJobs->Run([this, &frame] { buildImGui(frame.arena); }, &frameJobs, JobAffinity::MainThread);
 
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
-	{
-		recreateSwapChain();
-	}
-	else if (result != VK_SUCCESS)
 	{
-		throw std::runtime_error("Failed to present swap chain image!");
+		PROFILE_ZONE("Wait frame jobs");
+		mJobs->Wait(frameJobs);
 	}
-}
 
-void Application::mainLoop()
-{
-	lastX = mSwapChainExtent.width / 2.0f;
-	lastY = mSwapChainExtent.height / 2.0f;
+	mTaskGraphTime = static_cast<float>(getTime() - jobsStart);
 
-	while (!glfwWindowShouldClose(mWindow))
+	recordCommandBuffer(frame, imageIndex);
+
+	// Nothing recorded depends on the camera; the view only lives in the uniform buffer, which the GPU reads when it
+	// runs the frame. Sampling input here keeps the fence wait and a blocking acquire out of the latency. ImGui was
+	// built from the previous poll, so the overlay lags a frame behind in this mode.
+	if (mLowLatency)
 	{
-		glfwPollEvents();
+		PROFILE_ZONE("Late input");
 
-		calculateDelta();
+		if (mRenderThreadEnabled)
+		{
+			mSnapshots.Update();
+		}
+		else
+		{
+			pollInput();
+			updateCamera(deltaTime);
+		}
 
-		mCamera.ProcessKeyboard(mWindow, deltaTime);
+		updateUniformBuffer(frame);
+	}
 
-		updateUniformBuffer();
-		drawScene();
+	VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+
+	VkSemaphore waitSemaphores[] = { frame.imageAvailable };
+	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+	submitInfo.waitSemaphoreCount = mHeadless ? 0 : 1;
+	submitInfo.pWaitSemaphores = waitSemaphores;
+	submitInfo.pWaitDstStageMask = waitStages;
+
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &frame.commandBuffer;
+
+	VkSemaphore signalSemaphores[] = { frame.renderFinished };
+	submitInfo.signalSemaphoreCount = mHeadless ? 0 : 1;
+	submitInfo.pSignalSemaphores = signalSemaphores;
+
+	TimelineSubmit timelineSubmit;
+	mGraphicsTimeline.Signal(submitInfo, timelineSubmit);
+	frame.timelineValue = timelineSubmit.value;
+
+	mGpuProfiler.Submit();
+
+	frame.inputTime = mRenderThreadEnabled ? mSnapshots.Read().inputTime : mInputTime;
+	frame.latencyPending = !mHeadless;
+
+	if (mSubmission.IsRunning())
+	{
+		mSubmission.Submit(submitInfo, timelineSubmit.fence, "draw command buffer");
+	}
+	else
+	{
+		PROFILE_ZONE("vkQueueSubmit");
+
+		double submitStart = getTime();
+		VkResult res = vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, timelineSubmit.fence);
+		mQueueSubmitTime = static_cast<float>(getTime() - submitStart);
+
+		if (res != VK_SUCCESS)
+			throw std::runtime_error("failed to submit draw command buffer!");
+	}
+
+	mFrameNumber++;
+	mCurrentFrame = (mCurrentFrame + 1) % mFramesInFlight;
+
+	if (mHeadless)
+		return;
+
+	if (mSubmission.IsRunning())
+	{
+		// The result of this present arrives later; an out of date swap chain is picked up a frame late.
+		mSubmission.Present(mSwapChain, imageIndex, frame.renderFinished);
+		result = mSubmission.TakePresentResult();
 	}
+	else
+	{
+		VkPresentInfoKHR presentInfo{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+		presentInfo.waitSemaphoreCount = 1;
+		presentInfo.pWaitSemaphores = signalSemaphores;
+
+		VkSwapchainKHR swapChains[] = { mSwapChain };
+		presentInfo.swapchainCount = 1;
+		presentInfo.pSwapchains = swapChains;
+
+		presentInfo.pImageIndices = &imageIndex;
+
+		PROFILE_ZONE("vkQueuePresentKHR");
+
+		double presentStart = getTime();
+		result = vkQueuePresentKHR(mPresentQueue, &presentInfo);
+		mQueuePresentTime = static_cast<float>(getTime() - presentStart);
+	}
+
+	// The resize flag is set when the GLFW callback could not recreate right away: with a render thread, or from the
+	// low latency input poll in the middle of this frame.
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || mFramebufferResized.exchange(false))
+	{
+		recreateSwapChain();
+	}
+	else if (result != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to present swap chain image!");
+	}
+}
+
+void Application::mainLoop()
+{
+	lastX = mSwapChainExtent.width / 2.0f;
+	lastY = mSwapChainExtent.height / 2.0f;
+
+	if (mSubmitThreadEnabled)
+		mSubmission.Start(mDevice, mGraphicsQueue, mPresentQueue);
+
+	if (mRenderThreadEnabled)
+		runSimulation();
+	else
+		renderLoop();
+
+	mSubmission.Stop();
+
+	printFrameStats();
+	mGpuProfiler.PrintReport();
 
 	vkDeviceWaitIdle(mDevice);
+	mDeletionQueue.Flush(UINT64_MAX);
+	mFrameStatistics.Finish();
+
+	if (mHeadless && mFrameNumber > 0)
+		saveOffscreenImage(static_cast<uint32_t>((mFrameNumber - 1) % mSwapChainImages.size()), "headless_frame.ppm");
+
+	if (mBenchmark)
+	{
+		mBenchmarkReport.Print();
+		mBenchmarkReport.Write("benchmark_report.json", "benchmark_report.csv", mConfigs, mBenchmarkInput);
+	}
+
+	mInputRecorder.Close();
+
+	mPipelines->Reset([this](VkPipeline pipeline) { vkDestroyPipeline(mDevice, pipeline, mAllocator); });
+
+	mPipelineCache.Save();
+
+	Profiler::Get().Stop();
+}
+
+void Application::runSimulation()
+{
+	// The first frames need a camera before the first tick has run.
+	publishSnapshot();
+
+	std::exception_ptr renderError;
+	std::thread renderThread([this, &renderError]
+	{
+		Profiler::Get().SetThreadName("Render thread");
+
+		// ImGui is built as a MainThread job and has to run here, where the frame waits for it.
+		mJobs->SetMainThread();
+
+		try
+		{
+			renderLoop();
+		}
+		catch (...)
+		{
+			renderError = std::current_exception();
+		}
+
+		mRenderDone = true;
+		glfwPostEmptyEvent();
+	});
+
+	// Leaving with the render thread still joinable would terminate, so this also runs before an error is rethrown.
+	auto stopRenderThread = [this, &renderThread]
+	{
+		mRenderQuit = true;
+		renderThread.join();
+		mJobs->SetMainThread();
+	};
+
+	double tickPeriod = 1.0 / mInputRate;
+	double simulationStart = getTime();
+	double nextTick = simulationStart;
+	double lastTick = simulationStart;
+
+	try
+	{
+		while (!glfwWindowShouldClose(mWindow) && !mRenderDone)
+		{
+			double now = getTime();
+
+			// Events are still handled as they arrive while waiting; mouse look updates the camera from its callback.
+			if (now < nextTick)
+			{
+				PROFILE_ZONE("glfwWaitEventsTimeout");
+				glfwWaitEventsTimeout(nextTick - now);
+				continue;
+			}
+
+			PROFILE_ZONE("Simulation tick");
+
+			// A late tick moves the schedule instead of being followed by a burst of catch up ticks.
+			nextTick = std::max(nextTick + tickPeriod, now);
+
+			pollInput();
+
+			updateCamera(static_cast<float>(now - lastTick));
+			lastTick = now;
+
+			publishSnapshot();
+
+			mSimulationTicks++;
+		}
+	}
+	catch (...)
+	{
+		stopRenderThread();
+		throw;
+	}
+
+	mSimulationTime = getTime() - simulationStart;
+
+	stopRenderThread();
+
+	if (renderError)
+		std::rethrow_exception(renderError);
+}
+
+void Application::publishSnapshot()
+{
+	SimulationSnapshot& snapshot = mSnapshots.Write();
+
+	snapshot.view = mCamera.GetViewMatrix();
+	snapshot.cameraPosition = mCamera.Position;
+	snapshot.inputTime = mInputTime;
+
+	glfwGetWindowSize(mWindow, &snapshot.windowWidth, &snapshot.windowHeight);
+	glfwGetFramebufferSize(mWindow, &snapshot.framebufferWidth, &snapshot.framebufferHeight);
+	glfwGetCursorPos(mWindow, &snapshot.mouseX, &snapshot.mouseY);
+
+	for (int i = 0; i < 3; i++)
+		snapshot.mouseDown[i] = glfwGetMouseButton(mWindow, GLFW_MOUSE_BUTTON_1 + i) == GLFW_PRESS;
+
+	std::copy(std::begin(mKeysDown), std::end(mKeysDown), std::begin(snapshot.keysDown));
+
+	mSnapshots.Publish();
+}
+
+void Application::renderLoop()
+{
+	while ((mFrameLimit == 0 || mFrameCount < mFrameLimit) && (mHeadless || (mRenderThreadEnabled ? !mRenderQuit : !glfwWindowShouldClose(mWindow))))
+	{
+		PROFILE_ZONE("Frame");
+
+		double frameStart = getTime();
+
+		{
+			PROFILE_ZONE("Frame limiter");
+			mFramePacer.Wait();
+		}
+
+		if (!mLowLatency && !mRenderThreadEnabled)
+			pollInput();
+
+		calculateDelta();
+
+		HostAllocator::Get().BeginFrame();
+
+		uint64_t heapAllocations = AllocationCounter::GetCount();
+		uint64_t heapBytes = AllocationCounter::GetBytes();
+
+		drawScene();
+
+		if (mSubmission.IsRunning())
+		{
+			// The queue calls block the submission thread, not this one; what this thread waited on it is counted apart.
+			SubmissionStats queueStats = mSubmission.TakeFrameStats();
+			mQueueSubmitTime = static_cast<float>(queueStats.submitMs / 1000.0);
+			mQueuePresentTime = static_cast<float>(queueStats.presentMs / 1000.0);
+			mQueueBlockedTime = static_cast<float>(queueStats.blockedMs / 1000.0);
+		}
+
+		if (mFrameCount == 0)
+		{
+			std::cout << "First frame submitted " << getTime() * 1000.0 << " ms after startup with " << mPipelines->GetReadyCount() << " / "
+				<< mPipelines->GetCount() << " pipeline variants ready, " << mPipelines->GetFailedCount() << " failed\n";
+		}
+
+		mHeapAllocationsLastFrame = AllocationCounter::GetCount() - heapAllocations;
+		mHeapBytesLastFrame = AllocationCounter::GetBytes() - heapBytes;
+
+		// Measured rather than taken from deltaTime, which is fixed in benchmark runs.
+		double frameTime = getTime() - frameStart;
+
+		PROFILE_VALUE("Frame time ms", frameTime * 1000.0);
+		PROFILE_VALUE("Fence wait ms", mFenceWaitTime * 1000.0f);
+		PROFILE_VALUE("Queue submit ms", mQueueSubmitTime * 1000.0f);
+		PROFILE_VALUE("Queue present ms", mQueuePresentTime * 1000.0f);
+		PROFILE_VALUE("Queue blocked ms", mQueueBlockedTime * 1000.0f);
+		PROFILE_VALUE("Heap allocations", mHeapAllocationsLastFrame);
+		PROFILE_VALUE("Pending deletions", mDeletionQueue.GetPendingCount());
+
+		if (mBenchmark)
+		{
+			mBenchmarkReport.AddCpuFrame(mFrameCount, frameTime * 1000.0);
+
+			// Readbacks lag by the frames in flight; each one is attributed to the frame it was collected on.
+			if (mGpuProfiler.GetCollectedFrames() != mGpuFramesSampled)
+			{
+				mGpuFramesSampled = mGpuProfiler.GetCollectedFrames();
+				mBenchmarkReport.AddGpuFrame(mFrameCount, mGpuProfiler.GetLastFrameMs());
+			}
+		}
+
+		mFrameTimeTotal += frameTime;
+		mFenceWaitTotal += mFenceWaitTime;
+		mTaskGraphTimeTotal += mTaskGraphTime;
+		mQueueSubmitTotal += mQueueSubmitTime;
+		mQueuePresentTotal += mQueuePresentTime;
+		mQueueBlockedTotal += mQueueBlockedTime;
+		mFrameCount++;
+	}
 }
 
 void Application::createColorResources()
 {
-	VkFormat colorFormat = mSwapChainImageFormat;
+	TRACE_SCOPE("createColorResources");
 
-	createImage(mSwapChainExtent.width, mSwapChainExtent.height, colorFormat, VK_IMAGE_TILING_OPTIMAL, 
-		VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
-		mColorImage, mColorImageMemory, 1, mMSAASamples);
-	
-	createImageView(mColorImage, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT,mColorImageView, 1);
+	createTransientImage(mSwapChainExtent.width, mSwapChainExtent.height, mSwapChainImageFormat, 
+		VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, mColorImage, mMSAASamples);
 
-	transitionImageLayout(mColorImage, colorFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1);
+	// Pass 0 is the scene pass, the only one using transient attachments. Color and depth are both bound in it, so they
+	// overlap and get memory of their own; aliasing only pays off once attachments are used by disjoint passes.
+	mTransientAttachments.Add(mColorImage, "MSAA color", 0, 0);
 }
 
 void Application::createFramebuffers()
 {
-	mSwapChainFramebuffers.resize(mSwapChainImageViews.size(), VkDeleter<VkFramebuffer>{mDevice, vkDestroyFramebuffer});
+	TRACE_SCOPE("createFramebuffers");
+
+	mSwapChainFramebuffers.resize(mSwapChainImageViews.size());
 	
 	for (uint32_t i = 0; i < mSwapChainImageViews.size(); i++)
 	{
@@ -726,34 +1469,49 @@ void Application::createFramebuffers()
 		framebufferInfo.height = mSwapChainExtent.height;
 		framebufferInfo.layers = 1;
 
-		if (vkCreateFramebuffer(mDevice, &framebufferInfo, nullptr, mSwapChainFramebuffers[i].replace()) != VK_SUCCESS)
+		if (vkCreateFramebuffer(mDevice, &framebufferInfo, mAllocator, mSwapChainFramebuffers[i].replace(mDevice)) != VK_SUCCESS)
 			std::runtime_error("Failed to create framebuffer");
 	}
 }
 
 void Application::createCommandPool()
 {
+	TRACE_SCOPE("createCommandPool");
+
 	QueueFamilyIndices queueFamilyIndices = findQueueFamilies(mPhysDevice);
 
 	VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
 	poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
 	poolInfo.flags = 0;
 
-	if (vkCreateCommandPool(mDevice, &poolInfo, nullptr, mCommandPool.replace()) != VK_SUCCESS)
+	if (vkCreateCommandPool(mDevice, &poolInfo, mAllocator, mCommandPool.replace(mDevice)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create command pool!");
 }
 
 void Application::createDepthResources()
 {
+	TRACE_SCOPE("createDepthResources");
+
+	createTransientImage(mSwapChainExtent.width, mSwapChainExtent.height, findDepthFormat(), 
+		VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, mDepthImage, mMSAASamples);
+
+	// Same scene pass as the color attachment, see createColorResources.
+	mTransientAttachments.Add(mDepthImage, "Depth", 0, 0);
+}
+
+void Application::createTransientResources()
+{
+	TRACE_SCOPE("createTransientResources");
+
+	mTransientAttachments.Allocate();
+	mTransientAttachments.PrintReport(mSwapChainExtent, mMSAASamples);
+
+	VkFormat colorFormat = mSwapChainImageFormat;
 	VkFormat depthFormat = findDepthFormat();
 
-	createImage(mSwapChainExtent.width, mSwapChainExtent.height, depthFormat, 
-		VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
-		mDepthImage, mDepthImageMemory, 1, mMSAASamples);
-	
+	// The render pass starts both attachments from UNDEFINED, so no layout transition (and queue wait) is needed here.
+	createImageView(mColorImage, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT, mColorImageView, 1);
 	createImageView(mDepthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, mDepthImageView, 1);
-
-	transitionImageLayout(mDepthImage, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1);
 }
 
 void Application::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
@@ -776,27 +1534,33 @@ void Application::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t wid
 		1
 	};
 
+	mGpuProfiler.BeginScope(commandBuffer, "Texture upload");
 	vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+	mGpuProfiler.EndScope(commandBuffer);
 
 	endSingleTimeCommands(commandBuffer);
 }
 
 void Application::createTextureImage()
 {
-	int texWidth, texHeight, texChannels;
+	TRACE_SCOPE("createTextureImage");
 
-	stbi_uc* pixels = stbi_load(TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+	if (mParallelAssetLoading)
+		waitForAsset(mTextureDecoded, mTextureError);
+	else
+		decodeTexture();
 
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
+	int texWidth = mTextureWidth;
+	int texHeight = mTextureHeight;
+	stbi_uc* pixels = mTexturePixels;
 
-	if (!pixels)
-		throw std::runtime_error("Failed to load texture image!");
+	VkDeviceSize imageSize = texWidth * texHeight * 4;
 
 	mMipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
 
-	VkDeleter<VkBuffer> stagingBuffer{ mDevice, vkDestroyBuffer };
-	VkDeleter<VkDeviceMemory> stagingBufferMemory{mDevice, vkFreeMemory};
-	createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	VkHandle<VkBuffer, DestroyTrackedBuffer> stagingBuffer;
+	VkHandle<VkDeviceMemory, FreeTrackedMemory> stagingBufferMemory;
+	createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, "Texture staging");
 
 	void* data;
 	vkMapMemory(mDevice, stagingBufferMemory, 0, imageSize, 0, &data);
@@ -804,17 +1568,21 @@ void Application::createTextureImage()
 	vkUnmapMemory(mDevice, stagingBufferMemory);
 
 	stbi_image_free(pixels);
+	mTexturePixels = nullptr;
 
-	createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mTextureImage, mTextureImageMemory, mMipLevels, VK_SAMPLE_COUNT_1_BIT);
+	createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mTextureImage, mTextureImageMemory, mMipLevels, VK_SAMPLE_COUNT_1_BIT, TEXTURE_PATH);
 
 	transitionImageLayout(mTextureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mMipLevels);
 	copyBufferToImage(stagingBuffer, mTextureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+	mFrameStatistics.AddUpload(imageSize);
 	
 	generateMipmaps(mTextureImage, VK_FORMAT_R8G8B8A8_UNORM, texWidth, texHeight, mMipLevels);
 }
 
 void Application::createTextureImageView()
 {
+	TRACE_SCOPE("createTextureImageView");
+
 	createImageView(mTextureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, mTextureImageView, mMipLevels);
 }
 
@@ -828,6 +1596,8 @@ void Application::generateMipmaps(VkImage image, VkFormat imageFormat, int32_t t
 
 	auto commandBuffer = beginSingleTimeCommands();
 
+	mGpuProfiler.BeginScope(commandBuffer, "Mip generation");
+
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 	barrier.image = image;
@@ -902,11 +1672,15 @@ void Application::generateMipmaps(VkImage image, VkFormat imageFormat, int32_t t
 		0, nullptr,
 		1, &barrier);
 
+	mGpuProfiler.EndScope(commandBuffer);
+
 	endSingleTimeCommands(commandBuffer);
 }
 
 void Application::createTextureSampler()
 {
+	TRACE_SCOPE("createTextureSampler");
+
 	VkSamplerCreateInfo samplerInfo{ VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
 	samplerInfo.magFilter = VK_FILTER_LINEAR;
 	samplerInfo.minFilter = VK_FILTER_LINEAR;
@@ -939,186 +1713,555 @@ void Application::createTextureSampler()
 	}
 	samplerInfo.mipLodBias = 0.0f;
 
-	if (vkCreateSampler(mDevice, &samplerInfo, nullptr, mTextureSampler.replace()) != VK_SUCCESS)
+	if (vkCreateSampler(mDevice, &samplerInfo, mAllocator, mTextureSampler.replace(mDevice)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create texture sampler!");
 }
 
 void Application::createVertexBuffer()
 {
+	TRACE_SCOPE("createVertexBuffer");
+
 	VkDeviceSize bufferSize = sizeof(mVertices[0]) * mVertices.size();
 
-	VkDeleter<VkBuffer> stagingBuffer{ mDevice, vkDestroyBuffer };
-	VkDeleter<VkDeviceMemory> stagingBufferMemory{ mDevice, vkFreeMemory };
+	VkHandle<VkBuffer, DestroyTrackedBuffer> stagingBuffer;
+	VkHandle<VkDeviceMemory, FreeTrackedMemory> stagingBufferMemory;
 
-	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, "Vertex staging");
 
 	void* data;
 	vkMapMemory(mDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
 		memcpy(data, mVertices.data(), (size_t)bufferSize);
 	vkUnmapMemory(mDevice, stagingBufferMemory);
 
-	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mVertexBuffer, mVertexBufferMemory);
+	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mVertexBuffer, mVertexBufferMemory, "Vertex buffer");
 	copyBuffer(stagingBuffer, mVertexBuffer, bufferSize);
 }
 
-void Application::createIndexBuffer()
+void Application::createIndexBuffer()
+{
+	TRACE_SCOPE("createIndexBuffer");
+
+	VkDeviceSize bufferSize = sizeof(mIndices[0]) * mIndices.size();
+	VkHandle<VkBuffer, DestroyTrackedBuffer> stagingBuffer;
+	VkHandle<VkDeviceMemory, FreeTrackedMemory> stagingBufferMemory;
+
+	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, "Index staging");
+
+	void* data;
+	vkMapMemory(mDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
+		memcpy(data, mIndices.data(), (size_t)bufferSize);
+	vkUnmapMemory(mDevice, stagingBufferMemory);
+
+	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mIndexBuffer, mIndexBufferMemory, "Index buffer");
+	copyBuffer(stagingBuffer, mIndexBuffer, bufferSize);
+}
+
+void Application::createUniformBuffer()
+{
+	TRACE_SCOPE("createUniformBuffer");
+
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(mPhysDevice, &props);
+
+	// Every frame in flight owns one slice, so the CPU never writes a slice the GPU may still be reading.
+	VkDeviceSize alignment = std::max<VkDeviceSize>(props.limits.minUniformBufferOffsetAlignment, 1);
+	mUniformSliceSize = (sizeof(UniformBufferObject) + alignment - 1) / alignment * alignment;
+
+	VkDeviceSize bufferSize = mUniformSliceSize * mFramesInFlight;
+	createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mUniformBuffer, mUniformBufferMemory, "Uniform buffer");
+
+	void* data;
+	vkMapMemory(mDevice, mUniformBufferMemory, 0, bufferSize, 0, &data);
+	mUniformBufferMapped = static_cast<char*>(data);
+
+	for (uint32_t i = 0; i < mFramesInFlight; i++)
+		mFrames[i]->uniformOffset = mUniformSliceSize * i;
+}
+
+void Application::createDescriptorPool()
+{
+	TRACE_SCOPE("createDescriptorPool");
+
+	std::array<VkDescriptorPoolSize, 2> poolSizes = {};
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSizes[0].descriptorCount = mFramesInFlight;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[1].descriptorCount = mFramesInFlight;
+
+	VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	poolInfo.poolSizeCount = poolSizes.size();
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolInfo.maxSets = mFramesInFlight;
+
+	if (vkCreateDescriptorPool(mDevice, &poolInfo, mAllocator, mDescriptorPool.replace(mDevice)) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create descriptor pool!");
+}
+
+void Application::createDescriptorSets()
+{
+	TRACE_SCOPE("createDescriptorSets");
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.imageView = mTextureImageView;
+	imageInfo.sampler = mTextureSampler;
+
+	std::vector<VkDescriptorSetLayout> layouts(mFramesInFlight, mDescriptorSetLayout);
+	std::vector<VkDescriptorSet> descriptorSets(mFramesInFlight);
+
+	VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	allocInfo.descriptorPool = mDescriptorPool;
+	allocInfo.descriptorSetCount = mFramesInFlight;
+	allocInfo.pSetLayouts = layouts.data();
+
+	if (vkAllocateDescriptorSets(mDevice, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+		throw std::runtime_error("Failed to allocate descriptor sets!");
+
+	for (uint32_t i = 0; i < mFramesInFlight; i++)
+	{
+		FrameData& frame = *mFrames[i];
+		frame.descriptorSet = descriptorSets[i];
+
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = mUniformBuffer;
+		bufferInfo.offset = frame.uniformOffset;
+		bufferInfo.range = sizeof(UniformBufferObject);
+
+		std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[0].dstSet = frame.descriptorSet;
+		descriptorWrites[0].dstBinding = 0;
+		descriptorWrites[0].dstArrayElement = 0;
+		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		descriptorWrites[0].descriptorCount = 1;
+		descriptorWrites[0].pBufferInfo = &bufferInfo;
+
+		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[1].dstSet = frame.descriptorSet;
+		descriptorWrites[1].dstBinding = 1;
+		descriptorWrites[1].dstArrayElement = 0;
+		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descriptorWrites[1].descriptorCount = 1;
+		descriptorWrites[1].pImageInfo = &imageInfo;
+
+		vkUpdateDescriptorSets(mDevice, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+	}
+}
+
+void Application::createCommandBuffers()
+{
+	TRACE_SCOPE("createCommandBuffers");
+
+	QueueFamilyIndices indices = findQueueFamilies(mPhysDevice);
+
+	VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	poolInfo.queueFamilyIndex = indices.graphicsFamily;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+	uint32_t batchCount = mJobs->GetWorkerCount();
+
+	for (auto& frame : mFrames)
+	{
+		if (vkCreateCommandPool(mDevice, &poolInfo, mAllocator, frame->commandPool.replace(mDevice)) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create frame command pool!");
+
+		VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		allocInfo.commandPool = frame->commandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = 1;
+
+		if (vkAllocateCommandBuffers(mDevice, &allocInfo, &frame->commandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate command buffers!");
+
+		frame->threadPools.clear();
+		frame->threadPools.resize(batchCount);
+		frame->secondaryBuffers.resize(batchCount);
+		frame->batchCounters.resize(batchCount);
+
+		for (uint32_t i = 0; i < batchCount; i++)
+		{
+			if (vkCreateCommandPool(mDevice, &poolInfo, mAllocator, frame->threadPools[i].replace(mDevice)) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create thread command pool!");
+
+			allocInfo.commandPool = frame->threadPools[i];
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+			if (vkAllocateCommandBuffers(mDevice, &allocInfo, &frame->secondaryBuffers[i]) != VK_SUCCESS)
+				throw std::runtime_error("Failed to allocate secondary command buffers!");
+		}
+	}
+}
+
+void Application::recordDraws(FrameData& frame, uint32_t batch, uint32_t imageIndex)
+{
+	PROFILE_ZONE("recordDraws");
+
+	vkResetCommandPool(mDevice, frame.threadPools[batch], 0);
+
+	VkCommandBuffer commandBuffer = frame.secondaryBuffers[batch];
+
+	VkCommandBufferInheritanceInfo inheritanceInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+	inheritanceInfo.renderPass = mRenderPass;
+	inheritanceInfo.subpass = 0;
+	inheritanceInfo.framebuffer = mSwapChainFramebuffers[imageIndex];
+	inheritanceInfo.pipelineStatistics = mFrameStatistics.GetQueryFlags();
+
+	VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	DrawCounters counters;
+
+	VkPipeline boundPipeline = mGraphicsPipeline;
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, boundPipeline);
+	counters.pipelineBinds++;
+
+	// Secondary command buffers do not inherit dynamic state from the primary.
+	VkViewport viewport{};
+	viewport.width = static_cast<float>(mSwapChainExtent.width);
+	viewport.height = static_cast<float>(mSwapChainExtent.height);
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+	VkRect2D scissor{};
+	scissor.extent = mSwapChainExtent;
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+	VkBuffer vertexBuffers[] = { mVertexBuffer };
+	VkDeviceSize offsets[] = { 0 };
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+
+	vkCmdBindIndexBuffer(commandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+	counters.descriptorBinds++;
+
+	size_t batchCount = frame.secondaryBuffers.size();
+	size_t first = mDrawList.size() * batch / batchCount;
+	size_t last = mDrawList.size() * (batch + 1) / batchCount;
+
+	for (size_t i = first; i < last; i++)
+	{
+		const DrawCommand& draw = mDrawList[i];
+
+		VkPipeline pipeline = draw.variant < mResolvedPipelines.size() ? mResolvedPipelines[draw.variant] : boundPipeline;
+		if (pipeline != boundPipeline)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+			boundPipeline = pipeline;
+			counters.pipelineBinds++;
+		}
+
+		vkCmdDrawIndexed(commandBuffer, draw.indexCount, 1, draw.firstIndex, 0, 0);
+		counters.draws++;
+		counters.instances++;
+		counters.triangles += draw.indexCount / 3;
+	}
+
+	frame.batchCounters[batch] = counters;
+
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+		throw std::runtime_error("Failed to record secondary command buffer!");
+}
+
+void Application::recordCommandBuffer(FrameData& frame, uint32_t imageIndex)
+{
+	PROFILE_ZONE("recordCommandBuffer");
+
+	// The frame's timeline value has completed, so everything allocated from its pools can be recycled at once.
+	vkResetCommandPool(mDevice, frame.commandPool, 0);
+
+	VkCommandBuffer commandBuffer = frame.commandBuffer;
+
+	VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	mGpuProfiler.BeginFrame(commandBuffer, mCurrentFrame);
+	mGpuProfiler.BeginScope(commandBuffer, "GPU frame");
+
+	DrawCounters counters;
+	for (const auto& batch : frame.batchCounters)
+		counters += batch;
+
+	mFrameStatistics.BeginFrame(commandBuffer, mCurrentFrame, mFrameNumber, counters);
+
+	VkRenderPassBeginInfo renderPassInfo{ VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+	renderPassInfo.renderPass = mRenderPass;
+	renderPassInfo.framebuffer = mSwapChainFramebuffers[imageIndex];
+	renderPassInfo.renderArea.offset = { 0, 0 };
+	renderPassInfo.renderArea.extent = mSwapChainExtent;
+
+	std::array<VkClearValue, 2> clearValues;
+	clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
+	clearValues[1].depthStencil = { 1.0f, 0 };
+
+	renderPassInfo.clearValueCount = clearValues.size();
+	renderPassInfo.pClearValues = clearValues.data();
+
+	mGpuProfiler.BeginScope(commandBuffer, "Scene pass");
+	mFrameStatistics.BeginQuery(commandBuffer);
+	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+	{
+		vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(frame.secondaryBuffers.size()), frame.secondaryBuffers.data());
+	}
+	vkCmdEndRenderPass(commandBuffer);
+	mFrameStatistics.EndQuery(commandBuffer);
+	mGpuProfiler.EndScope(commandBuffer);
+
+	if (!mHeadless)
+	{
+		VkRenderPassBeginInfo imGuiPassInfo{ VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+		imGuiPassInfo.renderPass = mImGuiRenderPass;
+		imGuiPassInfo.framebuffer = mImGuiFramebuffers[imageIndex];
+		imGuiPassInfo.renderArea.offset = { 0, 0 };
+		imGuiPassInfo.renderArea.extent = mSwapChainExtent;
+
+		mGpuProfiler.BeginScope(commandBuffer, "ImGui pass");
+		vkCmdBeginRenderPass(commandBuffer, &imGuiPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		{
+			ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+		}
+		vkCmdEndRenderPass(commandBuffer);
+		mGpuProfiler.EndScope(commandBuffer);
+	}
+
+	mGpuProfiler.EndScope(commandBuffer);
+
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+		throw std::runtime_error("Failed to record command buffer!");
+}
+
+void Application::InitImGui()
+{
+	TRACE_SCOPE("InitImGui");
+
+	VkAttachmentDescription colorAttachment{};
+	colorAttachment.format = mSwapChainImageFormat;
+	colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	VkAttachmentReference colorAttachmentRef{};
+	colorAttachmentRef.attachment = 0;
+	colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colorAttachmentRef;
+
+	VkSubpassDependency dependency{};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	VkRenderPassCreateInfo renderPassInfo{ VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+	renderPassInfo.attachmentCount = 1;
+	renderPassInfo.pAttachments = &colorAttachment;
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = 1;
+	renderPassInfo.pDependencies = &dependency;
+
+	if (vkCreateRenderPass(mDevice, &renderPassInfo, mAllocator, mImGuiRenderPass.replace(mDevice)) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create ImGui render pass!");
+
+	std::array<VkDescriptorPoolSize, 1> poolSizes = {};
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[0].descriptorCount = 1;
+
+	VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	poolInfo.poolSizeCount = poolSizes.size();
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolInfo.maxSets = 1;
+
+	if (vkCreateDescriptorPool(mDevice, &poolInfo, mAllocator, mImGuiDescriptorPool.replace(mDevice)) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create ImGui descriptor pool!");
+
+	QueueFamilyIndices indices = findQueueFamilies(mPhysDevice);
+
+	IMGUI_CHECKVERSION();
+	ImGui::CreateContext();
+	ImGui::StyleColorsDark();
+
+	ImGui_ImplGlfw_InitForVulkan(mWindow, false);
+
+	ImGui_ImplVulkan_InitInfo initInfo{};
+	initInfo.Instance = mInstance;
+	initInfo.PhysicalDevice = mPhysDevice;
+	initInfo.Device = mDevice;
+	initInfo.QueueFamily = indices.graphicsFamily;
+	initInfo.Queue = mGraphicsQueue;
+	initInfo.PipelineCache = mPipelineCache;
+	initInfo.DescriptorPool = mImGuiDescriptorPool;
+	initInfo.Subpass = 0;
+	initInfo.MinImageCount = std::max<uint32_t>(2, static_cast<uint32_t>(mSwapChainImages.size()));
+	// ImGui rotates its vertex buffers by ImageCount, which has to cover every frame in flight.
+	initInfo.ImageCount = std::max<uint32_t>(mFramesInFlight, static_cast<uint32_t>(mSwapChainImages.size()));
+	initInfo.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
+	initInfo.Allocator = mAllocator;
+
+	ImGui_ImplVulkan_Init(&initInfo, mImGuiRenderPass);
+
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+	ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
+	endSingleTimeCommands(commandBuffer);
+
+	ImGui_ImplVulkan_DestroyFontUploadObjects();
+
+	createImGuiFramebuffers();
+}
+
+void Application::createImGuiFramebuffers()
 {
-	VkDeviceSize bufferSize = sizeof(mIndices[0]) * mIndices.size();
-	VkDeleter<VkBuffer> stagingBuffer{ mDevice, vkDestroyBuffer };
-	VkDeleter<VkDeviceMemory> stagingBufferMemory{ mDevice, vkFreeMemory };
+	mImGuiFramebuffers.clear();
+	mImGuiFramebuffers.resize(mSwapChainImageViews.size());
 
-	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	for (uint32_t i = 0; i < mSwapChainImageViews.size(); i++)
+	{
+		VkImageView attachment = mSwapChainImageViews[i];
 
-	void* data;
-	vkMapMemory(mDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, mIndices.data(), (size_t)bufferSize);
-	vkUnmapMemory(mDevice, stagingBufferMemory);
+		VkFramebufferCreateInfo framebufferInfo{ VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+		framebufferInfo.renderPass = mImGuiRenderPass;
+		framebufferInfo.attachmentCount = 1;
+		framebufferInfo.pAttachments = &attachment;
+		framebufferInfo.width = mSwapChainExtent.width;
+		framebufferInfo.height = mSwapChainExtent.height;
+		framebufferInfo.layers = 1;
 
-	createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mIndexBuffer, mIndexBufferMemory);
-	copyBuffer(stagingBuffer, mIndexBuffer, bufferSize);
+		if (vkCreateFramebuffer(mDevice, &framebufferInfo, mAllocator, mImGuiFramebuffers[i].replace(mDevice)) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create ImGui framebuffer!");
+	}
 }
 
-void Application::createUniformBuffer()
+void Application::createFrameResources()
 {
-	VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-	createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mUniformBuffer, mUniformBufferMemory);
-}
+	TRACE_SCOPE("createFrameResources");
 
-void Application::createDescriptorPool()
-{
-	std::array<VkDescriptorPoolSize, 2> poolSizes = {};
-	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	poolSizes[0].descriptorCount = 1;
-	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	poolSizes[1].descriptorCount = 1;
+	VkSemaphoreCreateInfo semaphoreInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
 
-	VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
-	poolInfo.poolSizeCount = poolSizes.size();
-	poolInfo.pPoolSizes = poolSizes.data();
-	poolInfo.maxSets = 1;
+	mFrames.clear();
 
-	if (vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, mDescriptorPool.replace()) != VK_SUCCESS)
-		throw std::runtime_error("Failed to create descriptor pool!");
+	for (uint32_t i = 0; i < mFramesInFlight; i++)
+	{
+		mFrames.push_back(std::make_unique<FrameData>());
+		FrameData& frame = *mFrames.back();
+
+		if (vkCreateSemaphore(mDevice, &semaphoreInfo, mAllocator, frame.imageAvailable.replace(mDevice)) != VK_SUCCESS ||
+			vkCreateSemaphore(mDevice, &semaphoreInfo, mAllocator, frame.renderFinished.replace(mDevice)) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create semaphores");
+	}
 }
 
-void Application::createDescriptorSet()
+void Application::drawFramePanel(FrameArena& arena)
 {
-	VkDescriptorImageInfo imageInfo{};
-	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	imageInfo.imageView = mTextureImageView;
-	imageInfo.sampler = mTextureSampler;
-
-	VkDescriptorSetLayout layouts[] = { mDescriptorSetLayout };
-	VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
-	allocInfo.descriptorPool = mDescriptorPool;
-	allocInfo.descriptorSetCount = 1;
-	allocInfo.pSetLayouts = layouts;
+	ImGui::Begin("Frame");
 
-	if (vkAllocateDescriptorSets(mDevice, &allocInfo, &mDescriptorSet) != VK_SUCCESS)
-		throw std::runtime_error("Failed to allocate descriptor set!");
+	ImGui::Text("Frame time: %.2f ms", deltaTime * 1000.0f);
+	ImGui::Text("Frames in flight: %u, max queued: %u", mFramesInFlight, mMaxQueuedFrames);
+	ImGui::Text("Present mode: %s, FPS limit: %u (waited %.2f ms)", presentModeName(mPresentMode), mFramePacer.GetFrameRateLimit(), mFramePacer.GetLastWaitMs());
 
-	VkDescriptorBufferInfo bufferInfo{};
-	bufferInfo.buffer = mUniformBuffer;
-	bufferInfo.offset = 0;
-	bufferInfo.range = sizeof(UniformBufferObject);
+	LatencyStats latency = mFramePacer.GetLatency();
+	ImGui::Text("Input to present (%s ordering): %.2f ms mean, %.2f ms p99, %.2f ms max", mLowLatency ? "low latency" : "default", latency.meanMs, latency.p99Ms, latency.maxMs);
+	ImGui::Text("Fence wait: %.2f ms, acquire: %.2f ms", mFenceWaitTime * 1000.0f, mAcquireWaitTime * 1000.0f);
+	ImGui::Text("Queue submit: %.3f ms, present: %.3f ms (%s)", mQueueSubmitTime * 1000.0f, mQueuePresentTime * 1000.0f, mSubmission.IsRunning() ? "submission thread" : "inline");
+	if (mSubmission.IsRunning())
+		ImGui::Text("Queue blocked: %.3f ms", mQueueBlockedTime * 1000.0f);
+	ImGui::Text("Frame jobs: %.3f ms, %zu draws on %u workers", mTaskGraphTime * 1000.0f, mDrawList.size(), mJobs->GetWorkerCount());
+	ImGui::Text("Pipeline variants ready: %u / %u, failed: %u", mPipelines->GetReadyCount(), mPipelines->GetCount(), mPipelines->GetFailedCount());
+	ImGui::Text("Heap allocations last frame: %llu (%llu bytes)", static_cast<unsigned long long>(mHeapAllocationsLastFrame), static_cast<unsigned long long>(mHeapBytesLastFrame));
+	ImGui::Text("Frame arena: %zu / %zu bytes", arena.GetUsed(), arena.GetCapacity());
 
-	std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
-	descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	descriptorWrites[0].dstSet = mDescriptorSet;
-	descriptorWrites[0].dstBinding = 0;
-	descriptorWrites[0].dstArrayElement = 0;
-	descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descriptorWrites[0].descriptorCount = 1;
-	descriptorWrites[0].pBufferInfo = &bufferInfo;
+	DeletionStats deletion = mDeletionQueue.GetStats();
+	ImGui::Text("Deletion queue: %zu pending (peak %zu), last batch %zu, %llu destroyed", deletion.pending, deletion.peakPending, deletion.lastBatch,
+		static_cast<unsigned long long>(deletion.destroyed));
 
-	descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	descriptorWrites[1].dstSet = mDescriptorSet;
-	descriptorWrites[1].dstBinding = 1;
-	descriptorWrites[1].dstArrayElement = 0;
-	descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	descriptorWrites[1].descriptorCount = 1;
-	descriptorWrites[1].pImageInfo = &imageInfo;
-
-	vkUpdateDescriptorSets(mDevice, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+	ImGui::End();
 }
 
-void Application::createCommandBuffers()
+void Application::buildImGui(FrameArena& arena)
 {
-	if (mCommandBuffers.size() > 0)
-		vkFreeCommandBuffers(mDevice, mCommandPool, mCommandBuffers.size(), mCommandBuffers.data());
+	PROFILE_ZONE("buildImGui");
 
-	mCommandBuffers.resize(mSwapChainFramebuffers.size());
-
-	VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
-	allocInfo.commandPool = mCommandPool;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandBufferCount = (uint32_t)mCommandBuffers.size();
-
-	if (vkAllocateCommandBuffers(mDevice, &allocInfo, mCommandBuffers.data()) != VK_SUCCESS)
-		throw std::runtime_error("Failed to allocate command buffers!");
+	ImGui_ImplVulkan_NewFrame();
+	if (mRenderThreadEnabled)
+		applyImGuiInput();
+	else
+		ImGui_ImplGlfw_NewFrame();
+	ImGui::NewFrame();
 
-	for (size_t i = 0; i < mCommandBuffers.size(); i++)
+	if (mMemoryPanelEnable)
 	{
-		VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-
-		vkBeginCommandBuffer(mCommandBuffers[i], &beginInfo);
+		drawFramePanel(arena);
+		MemoryTracker::Get().DrawPanel(&arena);
+		HostAllocator::Get().DrawPanel();
+		Profiler::Get().DrawPanel();
+		mGpuProfiler.DrawPanel();
+		mFrameStatistics.DrawPanel();
+	}
 
-		VkRenderPassBeginInfo renderPassInfo{ VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
-		renderPassInfo.renderPass = mRenderPass;
-		renderPassInfo.framebuffer = mSwapChainFramebuffers[i];
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = mSwapChainExtent;
+	ImGui::Render();
+}
 
-		std::array<VkClearValue, 2> clearValues;
-		clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
-		clearValues[1].depthStencil = { 1.0f, 0 };
+void Application::printFrameStats()
+{
+	if (mFrameCount == 0)
+		return;
 
-		renderPassInfo.clearValueCount = clearValues.size();
-		renderPassInfo.pClearValues = clearValues.data();
+	double frameTime = mFrameTimeTotal / mFrameCount * 1000.0;
+	double fenceWait = mFenceWaitTotal / mFrameCount * 1000.0;
 
-		vkCmdBeginRenderPass(mCommandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-		{
-			vkCmdBindPipeline(mCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, mGraphicsPipeline);
+	std::cout << "Frames in flight: " << mFramesInFlight << ", " << mFrameCount << " frames, average frame time " << frameTime
+		<< " ms, average fence wait " << fenceWait << " ms (" << (frameTime > 0.0 ? fenceWait / frameTime * 100.0 : 0.0) << "% of the frame CPU was stalled on the GPU)\n";
 
-			VkBuffer vertexBuffers[] = { mVertexBuffer };
-			VkDeviceSize offsets[] = { 0 };
-			vkCmdBindVertexBuffers(mCommandBuffers[i], 0, 1, vertexBuffers, offsets);
+	std::cout << "Frame jobs: " << mDrawList.size() << " draws on " << mJobs->GetWorkerCount() << " workers, average "
+		<< mTaskGraphTimeTotal / mFrameCount * 1000.0 << " ms\n";
 
-			vkCmdBindIndexBuffer(mCommandBuffers[i], mIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+	std::cout << "Queue calls " << (mSubmitThreadEnabled ? "on the submission thread" : "inline") << ": average submit " << mQueueSubmitTotal / mFrameCount * 1000.0
+		<< " ms, present " << mQueuePresentTotal / mFrameCount * 1000.0 << " ms per frame\n";
 
-			vkCmdBindDescriptorSets(mCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1, &mDescriptorSet, 0, nullptr);
+	if (mSubmitThreadEnabled)
+		std::cout << "Queue blocked: average " << mQueueBlockedTotal / mFrameCount * 1000.0 << " ms per frame waiting on the submission thread\n";
 
-			vkCmdDrawIndexed(mCommandBuffers[i], static_cast<uint32_t>(mIndices.size()), 1, 0, 0, 0);
-		}
-		vkCmdEndRenderPass(mCommandBuffers[i]);
+	DeletionStats deletion = mDeletionQueue.GetStats();
+	std::cout << "Deletion queue: " << deletion.retired << " objects retired, " << deletion.destroyed << " destroyed, peak " << deletion.peakPending
+		<< " pending, " << deletion.pending << " left for shutdown\n";
 
-		if (vkEndCommandBuffer(mCommandBuffers[i]) != VK_SUCCESS)
-			throw std::runtime_error("Failed to record command buffer!");
+	if (mRenderThreadEnabled && mSimulationTime > 0.0)
+	{
+		std::cout << "Render thread: " << mFrameCount << " frames, " << mSimulationTicks << " simulation ticks (" << mSimulationTicks / mSimulationTime
+			<< " per second, target " << mInputRate << ")\n";
 	}
-}
-
-void Application::InitImGui()
-{
-}
 
-void Application::createSemaphores()
-{
-	VkSemaphoreCreateInfo semaphoreInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
-	
-	if (vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, mImageAvailableSemaphore.replace()) != VK_SUCCESS ||
-		vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, mRenderFinishedSemaphore.replace()) != VK_SUCCESS)
-		throw std::runtime_error("Failed to create semaphores");
+	LatencyStats latency = mFramePacer.GetTotalLatency();
+	if (latency.count > 0)
+	{
+		std::cout << "Input to present latency (" << (mLowLatency ? "low latency" : "default") << " ordering, " << presentModeName(mPresentMode) << ", " << mMaxQueuedFrames << " queued frames, FPS limit "
+			<< mFramePacer.GetFrameRateLimit() << "): mean " << latency.meanMs << " ms, p99 " << latency.p99Ms << " ms, max " << latency.maxMs << " ms\n";
+	}
 }
 
-void Application::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags props, VkDeleter<VkBuffer>& buffer, VkDeleter<VkDeviceMemory>& bufferMemory)
+void Application::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags props, VkHandle<VkBuffer, DestroyTrackedBuffer>& buffer, VkHandle<VkDeviceMemory, FreeTrackedMemory>& bufferMemory, const std::string& tag)
 {
 	VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
 	bufferInfo.size = size;
 	bufferInfo.usage = usage;
 	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-	if (vkCreateBuffer(mDevice, &bufferInfo, nullptr, buffer.replace()) != VK_SUCCESS)
+	if (vkCreateBuffer(mDevice, &bufferInfo, mAllocator, buffer.replace(mDevice)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create buffer");
 
 	VkMemoryRequirements memRequirements;
@@ -1126,11 +2269,14 @@ void Application::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMe
 
 	VkMemoryAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
 	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, props);
+	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, props, memRequirements.size);
 
-	if (vkAllocateMemory(mDevice, &allocInfo, nullptr, bufferMemory.replace()) != VK_SUCCESS)
+	if (vkAllocateMemory(mDevice, &allocInfo, mAllocator, bufferMemory.replace(mDevice)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to allocate buffer memory!");
 
+	MemoryTracker::Get().TrackBuffer(buffer, tag, size, allocInfo.memoryTypeIndex);
+	MemoryTracker::Get().TrackMemory(bufferMemory, tag, allocInfo.allocationSize, allocInfo.memoryTypeIndex);
+
 	vkBindBufferMemory(mDevice, buffer, bufferMemory, 0);
 }
 
@@ -1139,90 +2285,258 @@ void Application::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSiz
 	auto commandBuffer = beginSingleTimeCommands();
 	VkBufferCopy copyRegion{};
 	copyRegion.size = size;
+
+	mGpuProfiler.BeginScope(commandBuffer, "Buffer upload");
 	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+	mGpuProfiler.EndScope(commandBuffer);
+
+	mFrameStatistics.AddUpload(size);
 
 	endSingleTimeCommands(commandBuffer);
 }
 
 void Application::recreateSwapChain()
 {
-	vkDeviceWaitIdle(mDevice);
+	PROFILE_ZONE("recreateSwapChain");
+
+	// Queued presents still name the current swap chain.
+	mSubmission.Flush();
+
+	int width = 0, height = 0;
+	if (mRenderThreadEnabled)
+	{
+		mSnapshots.Update();
+		width = mSnapshots.Read().framebufferWidth;
+		height = mSnapshots.Read().framebufferHeight;
+	}
+	else
+	{
+		glfwGetFramebufferSize(mWindow, &width, &height);
+	}
+
+	// A minimized window has no surface area to create a swap chain for.
+	if (width == 0 || height == 0)
+	{
+		if (mRenderThreadEnabled)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		else
+			glfwWaitEvents();
+		return;
+	}
+
+	HostAllocationStats hostStatsBefore = HostAllocator::Get().GetTotalStats();
+	double start = getTime();
+
+	// Frames in flight may still reference the old objects, so they are retired instead of destroyed.
+	for (auto& framebuffer : mSwapChainFramebuffers)
+		retire(framebuffer);
+	for (auto& framebuffer : mImGuiFramebuffers)
+		retire(framebuffer);
+	for (auto& imageView : mSwapChainImageViews)
+		retire(imageView);
+
+	retire(mColorImageView);
+	retire(mDepthImageView);
+	retire(mColorImage);
+	retire(mDepthImage);
+	mTransientAttachments.Retire(mDeletionQueue, mGraphicsTimeline.GetLastSignalled());
+
+	mSwapChainFramebuffers.clear();
+	mImGuiFramebuffers.clear();
+	mSwapChainImageViews.clear();
+
+	VkFormat previousFormat = mSwapChainImageFormat;
 
 	createSwapChain();
 	createImageViews();
-	createRenderPass();
-	createGraphicsPipeline();
+
+	// Viewport and scissor are dynamic, so the pipeline only depends on the attachment formats, which a resize keeps.
+	if (mSwapChainImageFormat != previousFormat)
+	{
+		mPipelines->Reset([this](VkPipeline pipeline) { mDeletionQueue.Push<vkDestroyPipeline>(mGraphicsTimeline.GetLastSignalled(), mDevice, pipeline); });
+
+		retire(mGraphicsPipeline);
+		retire(mRenderPass);
+
+		createRenderPass();
+		createGraphicsPipeline();
+		requestPipelineVariants();
+	}
+
 	createColorResources();
 	createDepthResources();
+	createTransientResources();
 	createFramebuffers();
-	createCommandBuffers();
+	createImGuiFramebuffers();
+
+	ImGui_ImplVulkan_SetMinImageCount(std::max<uint32_t>(2, static_cast<uint32_t>(mSwapChainImages.size())));
+
+	std::cout << "Swap chain recreated at " << mSwapChainExtent.width << "x" << mSwapChainExtent.height << " in " << (getTime() - start) * 1000.0
+		<< " ms, " << mDeletionQueue.GetPendingCount() << " objects pending deletion\n";
+
+	if (HostAllocator::Get().GetMode() != HostAllocatorMode::Disabled)
+	{
+		HostAllocationStats hostStatsAfter = HostAllocator::Get().GetTotalStats();
+
+		std::cout << "Swap chain recreation host allocations: " << hostStatsAfter.allocations - hostStatsBefore.allocations
+			<< " allocs, " << hostStatsAfter.frees - hostStatsBefore.frees << " frees, "
+			<< hostStatsAfter.bytesAllocated - hostStatsBefore.bytesAllocated << " bytes\n";
+	}
 }
 
-void Application::updateUniformBuffer()
+void Application::updateUniformBuffer(const FrameData& frame)
 {
+	PROFILE_ZONE("updateUniformBuffer");
+
 	UniformBufferObject ubo{};
 	glm::mat4 model = glm::mat4(1.0f);
 	model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
 	ubo.model= model;
-	ubo.view = mCamera.GetViewMatrix();
+	ubo.view = mRenderThreadEnabled ? mSnapshots.Read().view : mCamera.GetViewMatrix();
 	ubo.proj = glm::perspective(glm::radians(45.0f), (static_cast<float>(mSwapChainExtent.width) / static_cast<float>(mSwapChainExtent.height)), 0.1f, 100.0f);	
 	ubo.proj[1][1] *= -1;
 
 	ubo.lightPos = glm::vec3(2.0f, -2.0f, 4.0f);
-	ubo.viewPos = mCamera.Position;
+	ubo.viewPos = mRenderThreadEnabled ? mSnapshots.Read().cameraPosition : mCamera.Position;
 
-	void* data;
-	vkMapMemory(mDevice, mUniformBufferMemory, 0, sizeof(ubo), 0, &data);
-	memcpy(data, &ubo, sizeof(ubo));
-	vkUnmapMemory(mDevice, mUniformBufferMemory);
+	memcpy(mUniformBufferMapped + frame.uniformOffset, &ubo, sizeof(ubo));
+	mFrameStatistics.AddUpload(sizeof(ubo));
 }
 
 void Application::onWindowResized(GLFWwindow* window, int width, int height)
 {
+	PROFILE_ZONE("onWindowResized");
+
 	if (width <= 0 || height <= 0) return;
 
 	Application* app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+
+	// The render thread cannot recreate from here, and with low latency ordering this callback fires from the poll in
+	// the middle of drawScene, after the frame was recorded against the current swap chain. Both pick it up after present.
+	if (app->mRenderThreadEnabled || app->mLowLatency)
+	{
+		app->mFramebufferResized = true;
+		return;
+	}
+
 	app->recreateSwapChain();
 }
 
 void Application::onWindowCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-	if (action == GLFW_PRESS)
+	PROFILE_ZONE("onWindowCallback");
+
+	Application* app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+
+	app->mInputRecorder.RecordKey(key, action, mods);
+
+	// Kept for ImGui on the render thread, which cannot query GLFW itself.
+	if (key >= 0 && key <= GLFW_KEY_LAST && action != GLFW_REPEAT)
+		app->mKeysDown[key] = action == GLFW_PRESS;
+
+	app->handleKey(key, action);
+}
+
+void Application::handleKey(int key, int action)
+{
+	if (action != GLFW_PRESS)
+		return;
+
+	// Replays run through here too, possibly headless, so anything touching the window checks for one.
+	switch (key)
 	{
-		switch (key)
-		{
-		case GLFW_KEY_ESCAPE:
-			glfwSetWindowShouldClose(window, true);
+	case GLFW_KEY_ESCAPE:
+		if (mWindow)
+			glfwSetWindowShouldClose(mWindow, true);
+		break;
+	case GLFW_KEY_F1:
+		mMemoryPanelEnable = !mMemoryPanelEnable;
+		break;
+	case GLFW_KEY_F2:
+		MemoryTracker::Get().WriteJson("memory_stats.json");
+		std::cout << "Memory statistics written to memory_stats.json\n";
+		break;
+	case GLFW_KEY_F:
+		if (!mWindow)
 			break;
-		case GLFW_KEY_F:
-			if (glfwGetInputMode(window, GLFW_CURSOR) == GLFW_CURSOR_DISABLED)
-			{
-				glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-				glfwSetCursorPosCallback(window, nullptr);
-				break;
-			}
-			else if (glfwGetInputMode(window, GLFW_CURSOR) == GLFW_CURSOR_NORMAL)
-			{
-				glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-				glfwSetCursorPosCallback(window, Application::mouse_callback);
-				break;
-			}
+
+		if (glfwGetInputMode(mWindow, GLFW_CURSOR) == GLFW_CURSOR_DISABLED)
+		{
+			glfwSetInputMode(mWindow, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+			glfwSetCursorPosCallback(mWindow, nullptr);
 			break;
-		default:
+		}
+		else if (glfwGetInputMode(mWindow, GLFW_CURSOR) == GLFW_CURSOR_NORMAL)
+		{
+			glfwSetInputMode(mWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+			glfwSetCursorPosCallback(mWindow, Application::mouse_callback);
 			break;
 		}
+		break;
+	default:
+		break;
+	}
+}
+
+void Application::updateCamera(float timestep)
+{
+	PROFILE_ZONE("updateCamera");
+
+	if (mInputReplay.IsLoaded())
+	{
+		const InputFrame* input = mInputReplay.Next();
+
+		if (!input)
+			return;
+
+		for (const InputEvent& event : input->events)
+		{
+			if (event.type == InputEventType::Key)
+				handleKey(event.key, event.action);
+			else if (event.type == InputEventType::Cursor)
+				mCamera.ProcessMouseMovement(event.x, event.y, lastX, lastY);
+		}
+
+		// The recorded timestep, not the benchmark one, so the camera retraces the captured session.
+		mCamera.ProcessMovement(input->movement, input->deltaTime);
+	}
+	else if (mBenchmark)
+	{
+		CameraKey key = mCameraPath.Sample(static_cast<float>(currentFrame));
+		mCamera.SetPose(key.position, key.yaw, key.pitch);
+	}
+	else if (!mHeadless)
+	{
+		uint8_t movement = Camera::ReadMovementKeys(mWindow);
+		mCamera.ProcessMovement(movement, timestep);
+		mInputRecorder.EndFrame(timestep, movement);
 	}
 }
 
 void Application::mouse_callback(GLFWwindow* window, double xpos, double ypos)
 {
+	PROFILE_ZONE("mouse_callback");
+
 	Application* app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+
+	if (app->mBenchmark)
+		return;
+
+	app->mInputRecorder.RecordCursor(xpos, ypos);
 	app->mCamera.ProcessMouseMovement(xpos, ypos, app->lastX, app->lastY);
 }
 
 void Application::calculateDelta()
 {
-	currentFrame = glfwGetTime();
+	// A fixed step makes the camera land on the same poses every run, whatever the frame rate.
+	if (mBenchmark)
+	{
+		currentFrame = mFrameCount * static_cast<double>(BenchmarkTimestep);
+		deltaTime = BenchmarkTimestep;
+		return;
+	}
+
+	currentFrame = getTime();
 	deltaTime = currentFrame - lastFrame;
 	lastFrame = currentFrame;
 }
@@ -1276,11 +2590,19 @@ QueueFamilyIndices Application::findQueueFamilies(VkPhysicalDevice device)
 		if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
 			indices.graphicsFamily = i;
 
-		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, mSurface, &presentSupport);
+		// Nothing is presented without a surface; the graphics queue stands in so the rest of the setup is unchanged.
+		if (mHeadless)
+		{
+			indices.presentFamily = indices.graphicsFamily;
+		}
+		else
+		{
+			VkBool32 presentSupport = false;
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, mSurface, &presentSupport);
 
-		if (queueFamily.queueCount > 0 && presentSupport)
-			indices.presentFamily = i;
+			if (queueFamily.queueCount > 0 && presentSupport)
+				indices.presentFamily = i;
+		}
 
 		if (indices.isComplete())
 			break;
@@ -1322,19 +2644,30 @@ std::vector<const char*> Application::getRequiredExtensions()
 {
 	std::vector<const char*> extensions;
 
-	unsigned int glfwExtensionCount = 0;
-	const char** glfwExtensions;
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	if (!mHeadless)
+	{
+		unsigned int glfwExtensionCount = 0;
+		const char** glfwExtensions;
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-	for (unsigned int i = 0; i < glfwExtensionCount; i++)
-		extensions.push_back(glfwExtensions[i]);
+		for (unsigned int i = 0; i < glfwExtensionCount; i++)
+			extensions.push_back(glfwExtensions[i]);
+	}
 
 	if (mEnableValidationLayers)
 		extensions.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
 
+	if (checkInstanceExtensionSupport(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+		extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
 	return extensions;
 }
 
+std::vector<const char*> Application::getDeviceExtensions() const
+{
+	return mHeadless ? std::vector<const char*>{} : mDeviceExtensions;
+}
+
 bool Application::checkValidationLayerSupport()
 {
 	uint32_t layerCount;
@@ -1367,9 +2700,9 @@ bool Application::isDeviceSuitable(VkPhysicalDevice device)
 	QueueFamilyIndices indices = findQueueFamilies(device);
 
 	bool extensionsSupported = checkDeviceExtensionsSupport(device);
-	bool swapChainAdequate = false;
+	bool swapChainAdequate = mHeadless;
 
-	if (extensionsSupported)
+	if (extensionsSupported && !mHeadless)
 	{
 		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
 		swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -1386,7 +2719,8 @@ bool Application::checkDeviceExtensionsSupport(VkPhysicalDevice device)
 	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-	std::set<std::string> requiredExtensions(mDeviceExtensions.begin(), mDeviceExtensions.end());
+	std::vector<const char*> deviceExtensions = getDeviceExtensions();
+	std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
 	for (const auto& extension : availableExtensions)
 		requiredExtensions.erase(extension.extensionName);
@@ -1394,6 +2728,36 @@ bool Application::checkDeviceExtensionsSupport(VkPhysicalDevice device)
 	return requiredExtensions.empty();
 }
 
+bool Application::checkDeviceExtensionSupport(VkPhysicalDevice device, const char* extensionName)
+{
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+	for (const auto& extension : availableExtensions)
+		if (strcmp(extension.extensionName, extensionName) == 0)
+			return true;
+
+	return false;
+}
+
+bool Application::checkInstanceExtensionSupport(const char* extensionName)
+{
+	uint32_t extensionCount;
+	vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+
+	for (const auto& extension : availableExtensions)
+		if (strcmp(extension.extensionName, extensionName) == 0)
+			return true;
+
+	return false;
+}
+
 bool Application::hasStencilComponent(VkFormat format)
 {
 	return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
@@ -1415,11 +2779,100 @@ VkSurfaceFormatKHR Application::chooseSwapSurfaceFormat(const std::vector<VkSurf
 
 VkPresentModeKHR Application::chooseSwapPresentMode(const std::vector<VkPresentModeKHR> availablePresentModes)
 {
-	for (const auto& availablePresentMode : availablePresentModes)
-		if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-			return availablePresentMode;
+	static const VkPresentModeKHR requestedModes[] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+
+	VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+	if (mPresentModeSetting >= 1 && mPresentModeSetting <= 4)
+	{
+		VkPresentModeKHR requested = requestedModes[mPresentModeSetting - 1];
+
+		// FIFO is the only mode every implementation has to support.
+		if (std::find(availablePresentModes.begin(), availablePresentModes.end(), requested) != availablePresentModes.end())
+			presentMode = requested;
+		else if (mPresentMode == VK_PRESENT_MODE_MAX_ENUM_KHR)
+			std::cout << "Present mode " << presentModeName(requested) << " is not supported, falling back to FIFO\n";
+	}
+	else if (std::find(availablePresentModes.begin(), availablePresentModes.end(), VK_PRESENT_MODE_MAILBOX_KHR) != availablePresentModes.end())
+	{
+		presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+	}
+
+	if (presentMode != mPresentMode)
+		std::cout << "Present mode: " << presentModeName(presentMode) << '\n';
+
+	mPresentMode = presentMode;
+
+	return presentMode;
+}
+
+const char* Application::presentModeName(VkPresentModeKHR presentMode)
+{
+	switch (presentMode)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR:
+		return "IMMEDIATE";
+	case VK_PRESENT_MODE_MAILBOX_KHR:
+		return "MAILBOX";
+	case VK_PRESENT_MODE_FIFO_KHR:
+		return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+		return "FIFO_RELAXED";
+	default:
+		return "none";
+	}
+}
+
+void Application::pollInput()
+{
+	mInputTime = getTime();
+
+	if (!mHeadless)
+	{
+		PROFILE_ZONE("glfwPollEvents");
+		glfwPollEvents();
+	}
+}
+
+void Application::applyImGuiInput()
+{
+	const SimulationSnapshot& snapshot = mSnapshots.Read();
+	ImGuiIO& io = ImGui::GetIO();
+
+	io.DisplaySize = ImVec2(static_cast<float>(snapshot.windowWidth), static_cast<float>(snapshot.windowHeight));
+	if (snapshot.windowWidth > 0 && snapshot.windowHeight > 0)
+		io.DisplayFramebufferScale = ImVec2(static_cast<float>(snapshot.framebufferWidth) / snapshot.windowWidth, static_cast<float>(snapshot.framebufferHeight) / snapshot.windowHeight);
+
+	io.DeltaTime = std::max(deltaTime, 1.0f / 10000.0f);
+	io.MousePos = ImVec2(static_cast<float>(snapshot.mouseX), static_cast<float>(snapshot.mouseY));
+
+	for (int i = 0; i < 3; i++)
+		io.MouseDown[i] = snapshot.mouseDown[i];
+
+	// Only the key state crosses over, which covers navigation and shortcuts; nothing here takes text input.
+	for (int key = 0; key <= GLFW_KEY_LAST; key++)
+		io.KeysDown[key] = snapshot.keysDown[key];
+
+	io.KeyCtrl = snapshot.keysDown[GLFW_KEY_LEFT_CONTROL] || snapshot.keysDown[GLFW_KEY_RIGHT_CONTROL];
+	io.KeyShift = snapshot.keysDown[GLFW_KEY_LEFT_SHIFT] || snapshot.keysDown[GLFW_KEY_RIGHT_SHIFT];
+	io.KeyAlt = snapshot.keysDown[GLFW_KEY_LEFT_ALT] || snapshot.keysDown[GLFW_KEY_RIGHT_ALT];
+	io.KeySuper = snapshot.keysDown[GLFW_KEY_LEFT_SUPER] || snapshot.keysDown[GLFW_KEY_RIGHT_SUPER];
+}
+
+void Application::collectLatency()
+{
+	// Measured to when the CPU sees the frame's timeline value, which is after the GPU finished it and before it reaches the
+	// screen. Display timing would need VK_GOOGLE_display_timing, which is not widely available.
+	double now = getTime();
 
-	return VK_PRESENT_MODE_FIFO_KHR;
+	for (auto& frame : mFrames)
+	{
+		if (frame->latencyPending && mGraphicsTimeline.IsComplete(frame->timelineValue))
+		{
+			frame->latencyPending = false;
+			mFramePacer.AddLatency((now - frame->inputTime) * 1000.0);
+		}
+	}
 }
 
 VkExtent2D Application::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities)
@@ -1460,19 +2913,12 @@ VkFormat Application::findDepthFormat()
 	return findSupportedFormat({ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT }, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 }
 
-uint32_t Application::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags props)
+uint32_t Application::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags props, VkDeviceSize size)
 {
-	VkPhysicalDeviceMemoryProperties memProperties;
-	vkGetPhysicalDeviceMemoryProperties(mPhysDevice, &memProperties);
-
-	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-		if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & props) == props)
-			return i;
-
-	throw std::runtime_error("Failed to find suitable memory type!");
+	return MemoryTracker::Get().FindMemoryType(typeFilter, props, size);
 }
 
-void Application::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags props, VkDeleter<VkImage>& image, VkDeleter<VkDeviceMemory>& imageMemory, uint32_t mipLevels, VkSampleCountFlagBits numSamples)
+void Application::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags props, VkHandle<VkImage, DestroyTrackedImage>& image, VkHandle<VkDeviceMemory, FreeTrackedMemory>& imageMemory, uint32_t mipLevels, VkSampleCountFlagBits numSamples, const std::string& tag)
 {
 	VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
 	imageInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -1488,7 +2934,7 @@ void Application::createImage(uint32_t width, uint32_t height, VkFormat format,
 	imageInfo.samples = numSamples;
 	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-	if (vkCreateImage(mDevice, &imageInfo, nullptr, image.replace()) != VK_SUCCESS)
+	if (vkCreateImage(mDevice, &imageInfo, mAllocator, image.replace(mDevice)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create image!");
 
 	VkMemoryRequirements memReq;
@@ -1496,14 +2942,37 @@ void Application::createImage(uint32_t width, uint32_t height, VkFormat format,
 
 	VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
 	allocInfo.allocationSize = memReq.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, props);
+	allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, props, memReq.size);
 
-	if (vkAllocateMemory(mDevice, &allocInfo, nullptr, imageMemory.replace()) != VK_SUCCESS)
+	if (vkAllocateMemory(mDevice, &allocInfo, mAllocator, imageMemory.replace(mDevice)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to allocate image memory!");
 
+	MemoryTracker::Get().TrackImage(image, tag, memReq.size, allocInfo.memoryTypeIndex);
+	MemoryTracker::Get().TrackMemory(imageMemory, tag, allocInfo.allocationSize, allocInfo.memoryTypeIndex);
+
 	vkBindImageMemory(mDevice, image, imageMemory, 0);
 }
 
+void Application::createTransientImage(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkHandle<VkImage, DestroyTrackedImage>& image, VkSampleCountFlagBits numSamples)
+{
+	VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent.width = width;
+	imageInfo.extent.height = height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = format;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = usage;
+	imageInfo.samples = numSamples;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateImage(mDevice, &imageInfo, mAllocator, image.replace(mDevice)) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create transient image!");
+}
+
 VkCommandBuffer Application::beginSingleTimeCommands()
 {
 	VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
@@ -1519,6 +2988,8 @@ VkCommandBuffer Application::beginSingleTimeCommands()
 
 	vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
+	mGpuProfiler.BeginImmediate(commandBuffer);
+
 	return commandBuffer;
 }
 
@@ -1530,8 +3001,31 @@ void Application::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &commandBuffer;
 
-	vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(mGraphicsQueue);
+	TimelineSubmit timelineSubmit;
+	mGraphicsTimeline.Signal(submitInfo, timelineSubmit);
+
+	mGpuProfiler.Submit();
+
+	if (mSubmission.IsRunning())
+	{
+		mSubmission.Submit(submitInfo, timelineSubmit.fence, "single time command buffer");
+
+		// A failed submit never signals the value waited on below, so it has to be seen before that.
+		mSubmission.Flush();
+		mSubmission.CheckSubmitError();
+	}
+	else if (vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, timelineSubmit.fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to submit single time command buffer!");
+	}
+
+	// Only this upload, not whatever frames are still in flight on the queue.
+	{
+		PROFILE_ZONE("Wait for upload");
+		mGraphicsTimeline.Wait(timelineSubmit.value);
+	}
+
+	mGpuProfiler.EndImmediate();
 
 	vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
 }
@@ -1654,7 +3148,7 @@ void Application::copyImage(VkImage srcImage, VkImage dstImage, uint32_t width,
 	endSingleTimeCommands(commandBuffer);
 }
 
-void Application::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkDeleter<VkImageView>& imageView, uint32_t mipLevels)
+void Application::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkHandle<VkImageView, vkDestroyImageView>& imageView, uint32_t mipLevels)
 {
 	VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
 	viewInfo.image = image;
@@ -1666,22 +3160,24 @@ void Application::createImageView(VkImage image, VkFormat format, VkImageAspectF
 	viewInfo.subresourceRange.baseArrayLayer = 0;
 	viewInfo.subresourceRange.layerCount = 1;
 
-	if (vkCreateImageView(mDevice, &viewInfo, nullptr, imageView.replace()) != VK_SUCCESS)
+	if (vkCreateImageView(mDevice, &viewInfo, mAllocator, imageView.replace(mDevice)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create texture image view!");
 }
 
-void Application::createShaderModule(const std::vector<char>& code, VkDeleter<VkShaderModule>& shaderModule)
+void Application::createShaderModule(const std::vector<char>& code, VkHandle<VkShaderModule, vkDestroyShaderModule>& shaderModule)
 {
 	VkShaderModuleCreateInfo createInfo{ VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
 	createInfo.codeSize = code.size();
 	createInfo.pCode = (uint32_t*)code.data();
 
-	if (vkCreateShaderModule(mDevice, &createInfo, nullptr, shaderModule.replace()) != VK_SUCCESS)
+	if (vkCreateShaderModule(mDevice, &createInfo, mAllocator, shaderModule.replace(mDevice)) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create shader module!");
 }
 
 void Application::initWindow()
 {
+	TRACE_SCOPE("initWindow");
+
 	glfwInit();
 
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
@@ -1700,13 +3196,15 @@ void Application::initWindow()
 
 void Application::setupDebugCallback()
 {
+	TRACE_SCOPE("setupDebugCallback");
+
 	if (!mEnableValidationLayers) return;
 
 	VkDebugReportCallbackCreateInfoEXT createInfo{ VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT };
 	createInfo.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT;
 	createInfo.pfnCallback = debugCallback;
 
-	if (CreateDebugReportCallbackEXT(mInstance, &createInfo, nullptr, mCallback.replace()) != VK_SUCCESS) {
+	if (CreateDebugReportCallbackEXT(mInstance, &createInfo, mAllocator, mCallback.replace(mInstance)) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to set up debug callback!");
 	}
 }
@@ -3,7 +3,11 @@
 #ifndef APPLICATION_H
 #define APPLICATION_H
 
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <map>
+#include <memory>
 
 #include <ImGui/imgui.h>
 #include <ImGui/imgui_impl_glfw.h>
@@ -12,7 +16,22 @@
 #define GLFW_INCLUDE_NONE
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
-#include <Core/Vulkan/VkDeleter.h>
+#include <Core/Vulkan/VkHandle.h>
+#include <Core/Vulkan/MemoryTracker.h>
+#include <Core/Vulkan/TransientAttachments.h>
+#include <Core/Vulkan/DeletionQueue.h>
+#include <Core/Vulkan/PipelineCache.h>
+#include <Core/Vulkan/PipelineManager.h>
+#include <Core/Vulkan/QueueTimeline.h>
+#include <Core/Vulkan/SubmissionThread.h>
+#include <Core/Memory/FrameArena.h>
+#include <Core/Jobs/JobSystem.h>
+#include <Core/Jobs/TripleBuffer.h>
+#include <Core/Input/InputRecording.h>
+#include <Core/Timing/FramePacer.h>
+#include <Core/Profiling/BenchmarkReport.h>
+#include <Core/Profiling/FrameStatistics.h>
+#include <Core/Profiling/GpuProfiler.h>
 
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #define GLM_FORCE_RADIANS
@@ -22,6 +41,7 @@
 #include <glm/gtx/hash.hpp>
 
 #include <Components/Camera/Camera.h>
+#include <Components/Camera/CameraPath.h>
 
 struct QueueFamilyIndices
 {
@@ -101,19 +121,84 @@ struct UniformBufferObject
 	glm::vec3 viewPos;
 };
 
+struct DrawCommand
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t variant;
+};
+
+// Fixed function state that differs between the scene pipeline permutations.
+struct PipelineVariant
+{
+	VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+	VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+	float minSampleShading = 0.2f;
+};
+
+// Resources owned by one frame in flight. Nothing in here is touched by the CPU again until timelineValue has completed.
+struct FrameData
+{
+	// Graphics timeline value of the last submission from this slot.
+	uint64_t timelineValue = 0;
+	VkHandle<VkSemaphore, vkDestroySemaphore> imageAvailable;
+	VkHandle<VkSemaphore, vkDestroySemaphore> renderFinished;
+	VkHandle<VkCommandPool, vkDestroyCommandPool> commandPool;
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+
+	// One pool and secondary buffer per recording batch. Each batch is a single job, so no pool is used by two threads at once.
+	std::vector<VkHandle<VkCommandPool, vkDestroyCommandPool>> threadPools;
+	std::vector<VkCommandBuffer> secondaryBuffers;
+	std::vector<DrawCounters> batchCounters;
+
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	VkDeviceSize uniformOffset = 0;
+
+	FrameArena arena;
+
+	// When input was polled for the frame last submitted from this slot, until its timeline value is seen completed.
+	double inputTime = 0.0;
+	bool latencyPending = false;
+};
+
+// Camera and input state the simulation thread hands to the render thread once per tick.
+struct SimulationSnapshot
+{
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::vec3 cameraPosition = glm::vec3(0.0f);
+	double inputTime = 0.0;
+
+	// ImGui reads these through GLFW itself when everything runs on one thread; GLFW only allows that on the main one.
+	int windowWidth = 0;
+	int windowHeight = 0;
+	int framebufferWidth = 0;
+	int framebufferHeight = 0;
+	double mouseX = 0.0;
+	double mouseY = 0.0;
+	bool mouseDown[3] = {};
+	bool keysDown[GLFW_KEY_LAST + 1] = {};
+};
+
 VkResult CreateDebugReportCallbackEXT(VkInstance instance, const VkDebugReportCallbackCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugReportCallbackEXT* pCallback);
 void DestroyDebugReportCallbackEXT(VkInstance instance, VkDebugReportCallbackEXT callback, const VkAllocationCallbacks* pAllocator);
 
 class Application
 {
 public:
-	Application();
+	// Overrides take precedence over user.cfg; main fills them from the command line, along with the files
+	// CAMERA_PATH, RECORD_INPUT and REPLAY_INPUT.
+	Application(const std::map<std::string, uint32_t>& overrides = {}, const std::map<std::string, std::string>& files = {});
 	~Application();
 
 	void Run()
 	{
-		initWindow();
+		mRunStart = std::chrono::steady_clock::now();
+
+		startAssetLoading();
+		if (!mHeadless)
+			initWindow();
 		initVulkan();
+		printStartupTime();
 		mainLoop();
 	}
 private:
@@ -128,53 +213,116 @@ private:
 
 	uint32_t mMipLevels = 0;
 
-	VkDeleter<VkInstance> mInstance{ vkDestroyInstance };
-	VkDeleter<VkDebugReportCallbackEXT> mCallback{ mInstance, DestroyDebugReportCallbackEXT };
-	VkDeleter<VkSurfaceKHR> mSurface{ mInstance, vkDestroySurfaceKHR };
-	VkDeleter<VkDevice> mDevice{ vkDestroyDevice };
-	VkDeleter<VkSwapchainKHR> mSwapChain{ mDevice, vkDestroySwapchainKHR };
-	VkDeleter<VkRenderPass> mRenderPass{ mDevice, vkDestroyRenderPass };
-	VkDeleter<VkDescriptorSetLayout> mDescriptorSetLayout{ mDevice, vkDestroyDescriptorSetLayout };
-	VkDeleter<VkPipelineLayout> mPipelineLayout{ mDevice, vkDestroyPipelineLayout };
-	VkDeleter<VkPipeline> mGraphicsPipeline{ mDevice, vkDestroyPipeline };
+	const VkAllocationCallbacks* mAllocator = nullptr;
+
+	VkHandle<VkInstance, vkDestroyInstance> mInstance;
+	VkHandle<VkDebugReportCallbackEXT, DestroyDebugReportCallbackEXT> mCallback;
+	VkHandle<VkSurfaceKHR, vkDestroySurfaceKHR> mSurface;
+	DeviceHandle mDevice;
+	PipelineCache mPipelineCache{ mDevice };
+	GpuProfiler mGpuProfiler{ mDevice };
+	FrameStatistics mFrameStatistics{ mDevice };
+	VkHandle<VkSwapchainKHR, vkDestroySwapchainKHR> mSwapChain;
+	VkHandle<VkRenderPass, vkDestroyRenderPass> mRenderPass;
+	VkHandle<VkDescriptorSetLayout, vkDestroyDescriptorSetLayout> mDescriptorSetLayout;
+	VkHandle<VkPipelineLayout, vkDestroyPipelineLayout> mPipelineLayout;
+	VkHandle<VkPipeline, vkDestroyPipeline> mGraphicsPipeline;
+	VkHandle<VkShaderModule, vkDestroyShaderModule> mVertShaderModule;
+	VkHandle<VkShaderModule, vkDestroyShaderModule> mFragShaderModule;
 	
-	VkDeleter<VkSwapchainKHR> mSs{ mDevice, vkDestroySwapchainKHR };
-	VkDeleter<VkPipeline> mS{ mDevice, vkDestroyPipeline };
-
-	VkDeleter<VkCommandPool> mCommandPool{ mDevice, vkDestroyCommandPool };
+	VkHandle<VkSwapchainKHR, vkDestroySwapchainKHR> mSs;
+	VkHandle<VkPipeline, vkDestroyPipeline> mS;
 
-	VkDeleter<VkImage> mColorImage{ mDevice, vkDestroyImage };
-	VkDeleter<VkDeviceMemory> mColorImageMemory{ mDevice, vkFreeMemory };
-	VkDeleter<VkImageView> mColorImageView{ mDevice, vkDestroyImageView };
+	VkHandle<VkCommandPool, vkDestroyCommandPool> mCommandPool;
 
-	VkDeleter<VkImage> mDepthImage{ mDevice, vkDestroyImage };
-	VkDeleter<VkDeviceMemory> mDepthImageMemory{ mDevice, vkFreeMemory };
-	VkDeleter<VkImageView> mDepthImageView{ mDevice, vkDestroyImageView };
+	// Frames, one-off uploads and deferred deletion all go by values of the graphics queue's timeline.
+	QueueTimeline mGraphicsTimeline{ mDevice };
+	DeletionQueue mDeletionQueue;
+	uint64_t mFrameNumber = 0;
 
-	VkDeleter<VkImage> mTextureImage{ mDevice, vkDestroyImage };
-	VkDeleter<VkDeviceMemory> mTextureImageMemory{ mDevice, vkFreeMemory };
-	VkDeleter<VkImageView> mTextureImageView{ mDevice, vkDestroyImageView };
-	VkDeleter<VkSampler> mTextureSampler{ mDevice, vkDestroySampler };
-
-	VkDeleter<VkBuffer> mVertexBuffer{ mDevice, vkDestroyBuffer };
-	VkDeleter<VkDeviceMemory> mVertexBufferMemory{ mDevice, vkFreeMemory };
-	
-	VkDeleter<VkBuffer> mIndexBuffer{ mDevice, vkDestroyBuffer };
-	VkDeleter<VkDeviceMemory> mIndexBufferMemory{ mDevice, vkFreeMemory };
+	TransientAttachmentAllocator mTransientAttachments{ mDevice };
 
-	VkDeleter<VkBuffer> mUniformBuffer{ mDevice, vkDestroyBuffer };
-	VkDeleter<VkDeviceMemory> mUniformBufferMemory{ mDevice, vkFreeMemory };
+	VkHandle<VkImage, DestroyTrackedImage> mColorImage;
+	VkHandle<VkImageView, vkDestroyImageView> mColorImageView;
 
-	VkDeleter<VkDescriptorPool> mDescriptorPool{ mDevice, vkDestroyDescriptorPool };
-	VkDescriptorSet mDescriptorSet;
+	VkHandle<VkImage, DestroyTrackedImage> mDepthImage;
+	VkHandle<VkImageView, vkDestroyImageView> mDepthImageView;
 
-	std::vector<VkCommandBuffer> mCommandBuffers;
+	VkHandle<VkImage, DestroyTrackedImage> mTextureImage;
+	VkHandle<VkDeviceMemory, FreeTrackedMemory> mTextureImageMemory;
+	VkHandle<VkImageView, vkDestroyImageView> mTextureImageView;
+	VkHandle<VkSampler, vkDestroySampler> mTextureSampler;
 
-	VkDeleter<VkSemaphore> mImageAvailableSemaphore{ mDevice, vkDestroySemaphore };
-	VkDeleter<VkSemaphore> mRenderFinishedSemaphore{ mDevice, vkDestroySemaphore };
-
-	std::vector<VkDeleter<VkImageView>> mSwapChainImageViews;
-	std::vector<VkDeleter<VkFramebuffer>> mSwapChainFramebuffers;
+	VkHandle<VkBuffer, DestroyTrackedBuffer> mVertexBuffer;
+	VkHandle<VkDeviceMemory, FreeTrackedMemory> mVertexBufferMemory;
+	
+	VkHandle<VkBuffer, DestroyTrackedBuffer> mIndexBuffer;
+	VkHandle<VkDeviceMemory, FreeTrackedMemory> mIndexBufferMemory;
+
+	VkHandle<VkBuffer, DestroyTrackedBuffer> mUniformBuffer;
+	VkHandle<VkDeviceMemory, FreeTrackedMemory> mUniformBufferMemory;
+	VkDeviceSize mUniformSliceSize = 0;
+	char* mUniformBufferMapped = nullptr;
+
+	VkHandle<VkDescriptorPool, vkDestroyDescriptorPool> mDescriptorPool;
+
+	std::vector<std::unique_ptr<FrameData>> mFrames;
+	uint32_t mFramesInFlight = 2;
+
+	// PRESENT_MODE 0 keeps the old preference of mailbox, then FIFO; 1 to 4 ask for FIFO, FIFO_RELAXED, MAILBOX and
+	// IMMEDIATE. MAX_QUEUED_FRAMES lets the CPU run fewer frames ahead than there are frames in flight.
+	uint32_t mPresentModeSetting = 0;
+	VkPresentModeKHR mPresentMode = VK_PRESENT_MODE_MAX_ENUM_KHR;
+	uint32_t mMaxQueuedFrames = 2;
+	FramePacer mFramePacer;
+	double mInputTime = 0.0;
+	bool mKeysDown[GLFW_KEY_LAST + 1] = {};
+
+	// LOW_LATENCY moves the input poll, camera and uniform update from the start of the frame to after the fence wait,
+	// acquire and command recording, right before submit.
+	bool mLowLatency = false;
+
+	// RENDER_THREAD leaves the GLFW event loop and camera on the main thread, ticking INPUT_RATE times a second, and
+	// moves all Vulkan work to a render thread. Snapshots go across in a triple buffer, so neither side waits on the
+	// other and a blocking acquire or present no longer holds up input.
+	bool mRenderThreadEnabled = false;
+	uint32_t mInputRate = 240;
+	TripleBuffer<SimulationSnapshot> mSnapshots;
+	std::atomic<bool> mRenderQuit{ false };
+	std::atomic<bool> mRenderDone{ false };
+	std::atomic<bool> mFramebufferResized{ false };
+	uint64_t mSimulationTicks = 0;
+	double mSimulationTime = 0.0;
+
+	// SUBMIT_THREAD hands queue submits and presents to a thread of their own. The time blocked in those
+	// calls is tracked either way, so both setups can be compared.
+	bool mSubmitThreadEnabled = false;
+	SubmissionThread mSubmission;
+	float mQueueSubmitTime = 0.0f;
+	float mQueuePresentTime = 0.0f;
+	float mQueueBlockedTime = 0.0f;
+	double mQueueSubmitTotal = 0.0;
+	double mQueuePresentTotal = 0.0;
+	double mQueueBlockedTotal = 0.0;
+	uint32_t mCurrentFrame = 0;
+
+	float mFenceWaitTime = 0.0f;
+	float mAcquireWaitTime = 0.0f;
+	float mTaskGraphTime = 0.0f;
+	double mFrameTimeTotal = 0.0;
+	double mFenceWaitTotal = 0.0;
+	double mTaskGraphTimeTotal = 0.0;
+	uint64_t mFrameCount = 0;
+
+	uint64_t mHeapAllocationsLastFrame = 0;
+	uint64_t mHeapBytesLastFrame = 0;
+
+	VkHandle<VkRenderPass, vkDestroyRenderPass> mImGuiRenderPass;
+	VkHandle<VkDescriptorPool, vkDestroyDescriptorPool> mImGuiDescriptorPool;
+	std::vector<VkHandle<VkFramebuffer, vkDestroyFramebuffer>> mImGuiFramebuffers;
+
+	std::vector<VkHandle<VkImageView, vkDestroyImageView>> mSwapChainImageViews;
+	std::vector<VkHandle<VkFramebuffer, vkDestroyFramebuffer>> mSwapChainFramebuffers;
 	
 	VkPhysicalDevice mPhysDevice = VK_NULL_HANDLE;
 	VkQueue mGraphicsQueue;
@@ -185,21 +333,68 @@ private:
 
 	std::vector<VkImage> mSwapChainImages;
 
+	// Headless runs render a fixed number of frames into these instead of a swap chain, one per frame in flight.
+	bool mHeadless = false;
+	uint32_t mHeadlessFrames = 0;
+	std::vector<VkHandle<VkImage, DestroyTrackedImage>> mOffscreenImages;
+	std::vector<VkHandle<VkDeviceMemory, FreeTrackedMemory>> mOffscreenImageMemory;
+
 	const unsigned int mWIDTH = 1600;
 	const unsigned int mHEIGHT = 900;
 
 	Camera mCamera;
 	bool mCameraInput = true;
 
+	// Benchmark runs fly the camera along a path with a fixed timestep instead of taking input, for warmup plus
+	// BENCHMARK_FRAMES frames, and report CPU and GPU frame time percentiles.
+	bool mBenchmark = false;
+	uint32_t mFrameLimit = 0;
+	std::string mCameraPathFile;
+	CameraPath mCameraPath;
+	BenchmarkReport mBenchmarkReport;
+	uint64_t mGpuFramesSampled = 0;
+	static constexpr float BenchmarkTimestep = 1.0f / 60.0f;
+
+	// A replay takes the place of the camera path and lasts as long as the recording.
+	InputRecorder mInputRecorder;
+	InputReplay mInputReplay;
+	std::string mBenchmarkInput;
+
 	const std::vector<const char*> mValidationLayers = { "VK_LAYER_KHRONOS_validation", "VK_LAYER_LUNARG_monitor" };
 	const std::vector<const char*> mDeviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	bool mMemoryBudgetSupported = false;
+	bool mTimelineSupported = false;
+	std::atomic<bool> mMemoryPanelEnable{ true };
+
+	// Disk reads and decoding do not need the device, so they run on jobs while Vulkan is brought up.
+	bool mParallelAssetLoading = false;
+	std::chrono::steady_clock::time_point mRunStart;
+
+	JobCounter mModelLoaded;
+	JobCounter mTextureDecoded;
+	std::exception_ptr mModelError;
+	std::exception_ptr mTextureError;
+
+	int mTextureWidth = 0;
+	int mTextureHeight = 0;
+	unsigned char* mTexturePixels = nullptr;
 
 	std::vector<Vertex> mVertices;
 
 	std::vector<uint32_t> mIndices;
+	std::vector<DrawCommand> mDrawList;
+
+	std::unique_ptr<JobSystem> mJobs;
+
+	// Draws whose variant is still compiling use mGraphicsPipeline instead.
+	std::unique_ptr<PipelineManager> mPipelines;
+	std::vector<PipelineVariant> mPipelineVariants;
+	std::vector<PipelineHandle> mPipelineHandles;
+	std::vector<VkPipeline> mResolvedPipelines;
 
 	const std::string MODEL_PATH = "Models/viking_room.obj";
 	const std::string TEXTURE_PATH = "Textures/viking_room.png";
+	const std::string PIPELINE_CACHE_PATH = "pipeline_cache.bin";
 
 	ImGui_ImplVulkanH_Window mImGuiWindow;
 
@@ -223,6 +418,13 @@ private:
 	
 	static void onWindowResized(GLFWwindow* window, int width, int height);
 	static void onWindowCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	void handleKey(int key, int action);
+	void pollInput();
+	void runSimulation();
+	void publishSnapshot();
+	void renderLoop();
+	void applyImGuiInput();
+	void updateCamera(float timestep);
 	static void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 
 	void calculateDelta();
@@ -231,14 +433,19 @@ private:
 	SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
 	std::vector<const char*> getRequiredExtensions();
+	std::vector<const char*> getDeviceExtensions() const;
 
 	bool checkValidationLayerSupport();
 	bool isDeviceSuitable(VkPhysicalDevice device);
 	bool checkDeviceExtensionsSupport(VkPhysicalDevice device);
+	bool checkDeviceExtensionSupport(VkPhysicalDevice device, const char* extensionName);
+	bool checkInstanceExtensionSupport(const char* extensionName);
 	bool hasStencilComponent(VkFormat format);
 
 	VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 	VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR> availablePresentModes);
+	static const char* presentModeName(VkPresentModeKHR presentMode);
+	void collectLatency();
 	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
 	VkFormat findSupportedFormat(const std::vector<VkFormat>& canditates, VkImageTiling tiling, VkFormatFeatureFlags features);
 	VkFormat findDepthFormat();
@@ -251,15 +458,16 @@ private:
 	uint32_t mAnisatropyLevel = 0;
 	VkSampleCountFlagBits mMSAASamples = VK_SAMPLE_COUNT_1_BIT;
 
-	void createShaderModule(const std::vector<char>& code, VkDeleter<VkShaderModule>& shaderModule);
-	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags props);
-	void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags props, VkDeleter<VkImage>& image, VkDeleter<VkDeviceMemory>& imageMemory, uint32_t mipLevels, VkSampleCountFlagBits numSamples);
+	void createShaderModule(const std::vector<char>& code, VkHandle<VkShaderModule, vkDestroyShaderModule>& shaderModule);
+	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags props, VkDeviceSize size);
+	void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags props, VkHandle<VkImage, DestroyTrackedImage>& image, VkHandle<VkDeviceMemory, FreeTrackedMemory>& imageMemory, uint32_t mipLevels, VkSampleCountFlagBits numSamples, const std::string& tag);
+	void createTransientImage(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkHandle<VkImage, DestroyTrackedImage>& image, VkSampleCountFlagBits numSamples);
 	VkCommandBuffer beginSingleTimeCommands();
 	void endSingleTimeCommands(VkCommandBuffer commandBuffer);
 	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevel);
 	void copyImage(VkImage srcImage, VkImage dstImage, uint32_t width, uint32_t height);
 	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
-	void createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkDeleter<VkImageView>& imageView, uint32_t mipLevels);
+	void createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkHandle<VkImageView, vkDestroyImageView>& imageView, uint32_t mipLevels);
 	VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
 	void generateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
 
@@ -270,33 +478,65 @@ private:
 	void createSurface();
 	void pickPhysicalDevice();
 	void createLogicalDevice();
+	void createPipelineCache();
 	void createSwapChain();
+	void createOffscreenImages();
+	void saveOffscreenImage(uint32_t imageIndex, const std::string& fileName);
 	void createImageViews();
 	void createRenderPass();
 	void createDescriptorSetLayout();
 	void createGraphicsPipeline();
+	VkPipeline buildGraphicsPipeline(const PipelineVariant& variant);
+	void requestPipelineVariants();
+	void resolvePipelines();
 	void createFramebuffers();
 	void createCommandPool();
 	void createColorResources();
 	void createDepthResources();
+	void createTransientResources();
 	void createTextureImage();
 	void createTextureImageView();
 	void createTextureSampler();
+	void startAssetLoading();
+	void waitForAsset(JobCounter& counter, std::exception_ptr& error);
+	void printStartupTime();
+	void decodeTexture();
 	void loadModel();
 	void createVertexBuffer();
 	void createIndexBuffer();
 	void createUniformBuffer();
 	void createDescriptorPool();
-	void createDescriptorSet();
+	void createDescriptorSets();
+	void createFrameResources();
 	void createCommandBuffers();
-	void createSemaphores();
 	void InitImGui();
-
-	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags props, VkDeleter<VkBuffer>& buffer, VkDeleter<VkDeviceMemory>& bufferMemory);
+	void createImGuiFramebuffers();
+	void buildDrawList();
+	void recordCommandBuffer(FrameData& frame, uint32_t imageIndex);
+	void recordDraws(FrameData& frame, uint32_t batch, uint32_t imageIndex);
+	void buildImGui(FrameArena& arena);
+	void drawFramePanel(FrameArena& arena);
+	void printFrameStats();
+
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags props, VkHandle<VkBuffer, DestroyTrackedBuffer>& buffer, VkHandle<VkDeviceMemory, FreeTrackedMemory>& bufferMemory, const std::string& tag);
 	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 
 	void recreateSwapChain();
-	void updateUniformBuffer();
+
+	// Seconds since Run(). glfwGetTime needs an initialized GLFW, which headless runs never have.
+	double getTime() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - mRunStart).count(); }
+
+	// Queues the object for destruction once everything submitted so far has completed.
+	template <class T, auto Destroy>
+	void retire(VkHandle<T, Destroy>& object)
+	{
+		T handle = object.release();
+		if (handle == VK_NULL_HANDLE)
+			return;
+
+		mDeletionQueue.Push<Destroy>(mGraphicsTimeline.GetLastSignalled(), mDevice, handle);
+	}
+	void updateUniformBuffer(const FrameData& frame);
 
 	void initVulkan();
 
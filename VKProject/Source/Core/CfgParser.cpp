@@ -1,5 +1,7 @@
 #include "CfgParser.h"
 
+#include <cstdlib>
+#include <sstream>
 #include <vector>
 
 CfgParser::CfgParser()
@@ -13,6 +15,28 @@ CfgParser::CfgParser()
 		mConfigFile << "MIPMAPS=FALSE\n";
 		mConfigFile << "ANISOTROPY=0\n";
 		mConfigFile << "SAMPLE_RATE_SHADING=FALSE\n";
+		mConfigFile << "HOST_ALLOCATOR=0\n";
+		mConfigFile << "FRAMES_IN_FLIGHT=2\n";
+		mConfigFile << "JOB_WORKERS=0\n";
+		mConfigFile << "DRAW_COUNT=1\n";
+		mConfigFile << "PIPELINE_VARIANTS=8\n";
+		mConfigFile << "PARALLEL_ASSET_LOADING=TRUE\n";
+		mConfigFile << "TRACE_STARTUP=FALSE\n";
+		mConfigFile << "PROFILER=FALSE\n";
+		mConfigFile << "FRAME_STATS_CSV=FALSE\n";
+		mConfigFile << "HEADLESS=FALSE\n";
+		mConfigFile << "HEADLESS_FRAMES=300\n";
+		mConfigFile << "BENCHMARK=FALSE\n";
+		mConfigFile << "BENCHMARK_FRAMES=1000\n";
+		mConfigFile << "BENCHMARK_WARMUP=120\n";
+		mConfigFile << "PRESENT_MODE=0\n";
+		mConfigFile << "FPS_LIMIT=0\n";
+		mConfigFile << "MAX_QUEUED_FRAMES=0\n";
+		mConfigFile << "LOW_LATENCY=FALSE\n";
+		mConfigFile << "RENDER_THREAD=FALSE\n";
+		mConfigFile << "INPUT_RATE=240\n";
+		mConfigFile << "SUBMIT_THREAD=FALSE\n";
+		mConfigFile << "TIMELINE_SEMAPHORES=TRUE\n";
 		mConfigFile.close();
 	}
 
@@ -24,7 +48,7 @@ CfgParser::CfgParser()
 
 	mConfigFile.read(buffer.data(), fileSize);
 
-	mConfigList = buffer.data();
+	mConfigList.assign(buffer.data(), buffer.size());
 
 	mConfigFile.close();
 }
@@ -32,3 +56,47 @@ CfgParser::CfgParser()
 CfgParser::~CfgParser()
 {
 }
+
+std::map<std::string, uint32_t> CfgParser::GetValues()
+{
+	std::map<std::string, uint32_t> values;
+	std::istringstream configs(mConfigList);
+	std::string line;
+
+	while (std::getline(configs, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		size_t separator = line.find("=");
+		if (separator == std::string::npos)
+			continue;
+
+		std::string key = line.substr(0, separator);
+		std::string value = line.substr(separator + 1);
+
+		values[key] = value == "TRUE" ? 1 : atoi(value.c_str());
+	}
+
+	return values;
+}
+
+
+std::string CfgParser::GetEnvironment(const char* name)
+{
+#ifdef _MSC_VER
+	char* buffer = nullptr;
+	size_t size = 0;
+
+	if (_dupenv_s(&buffer, &size, name) != 0 || !buffer)
+		return {};
+
+	std::string value(buffer);
+	free(buffer);
+
+	return value;
+#else
+	const char* value = std::getenv(name);
+	return value ? value : "";
+#endif
+}
\ No newline at end of file
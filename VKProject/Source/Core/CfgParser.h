@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
 
 class CfgParser
 {
@@ -13,6 +14,10 @@ public:
 	~CfgParser();
 
 	std::string GetConfigs() { return mConfigList; }
+	std::map<std::string, uint32_t> GetValues();
+
+	// Value of an environment variable, or an empty string if it is not set.
+	static std::string GetEnvironment(const char* name);
 private:
 	std::fstream mConfigFile;
 	std::string mConfigList;
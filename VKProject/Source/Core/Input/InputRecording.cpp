@@ -0,0 +1,169 @@
+#include "InputRecording.h"
+
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+	const char Magic[4] = { 'V', 'K', 'I', 'R' };
+	// Version 2 added event timestamps.
+	const uint32_t Version = 2;
+}
+
+InputRecorder::~InputRecorder()
+{
+	Close();
+}
+
+void InputRecorder::Open(const std::string& fileName)
+{
+	mFile.open(fileName, std::ios::binary | std::ios::trunc);
+
+	if (!mFile.is_open())
+		throw std::runtime_error("Failed to open file! (" + fileName + ")");
+
+	mFileName = fileName;
+	mStart = std::chrono::steady_clock::now();
+	mFrames = 0;
+	mEvents = 0;
+
+	mFile.write(Magic, sizeof(Magic));
+	write(Version);
+
+	std::cout << "Recording input to " << fileName << '\n';
+}
+
+void InputRecorder::Close()
+{
+	if (!mFile.is_open())
+		return;
+
+	mFile.close();
+
+	std::cout << "Input recording " << mFileName << ": " << mFrames << " frames, " << mEvents << " events\n";
+}
+
+void InputRecorder::RecordKey(int key, int action, int mods)
+{
+	if (!mFile.is_open())
+		return;
+
+	write(InputEventType::Key);
+	write(std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count());
+	write(static_cast<int16_t>(key));
+	write(static_cast<uint8_t>(action));
+	write(static_cast<uint8_t>(mods));
+
+	mEvents++;
+}
+
+void InputRecorder::RecordCursor(double x, double y)
+{
+	if (!mFile.is_open())
+		return;
+
+	write(InputEventType::Cursor);
+	write(std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count());
+	write(x);
+	write(y);
+
+	mEvents++;
+}
+
+void InputRecorder::EndFrame(float deltaTime, uint8_t movement)
+{
+	if (!mFile.is_open())
+		return;
+
+	write(InputEventType::Frame);
+	write(deltaTime);
+	write(movement);
+
+	mFrames++;
+}
+
+void InputReplay::Load(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+
+	if (!file.is_open())
+		throw std::runtime_error("Failed to open file! (" + fileName + ")");
+
+	std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	size_t offset = 0;
+
+	auto read = [&](auto& value)
+	{
+		if (offset + sizeof(value) > data.size())
+			throw std::runtime_error("Input recording is truncated! (" + fileName + ")");
+
+		std::memcpy(&value, data.data() + offset, sizeof(value));
+		offset += sizeof(value);
+	};
+
+	char magic[4];
+	uint32_t version = 0;
+	read(magic);
+	read(version);
+
+	if (std::memcmp(magic, Magic, sizeof(Magic)) != 0 || version != Version)
+		throw std::runtime_error("Not a supported input recording! (" + fileName + ")");
+
+	mFrames.clear();
+	mNext = 0;
+
+	InputFrame frame;
+	size_t events = 0;
+	double lastTime = 0.0;
+
+	while (offset < data.size())
+	{
+		InputEventType type;
+		read(type);
+
+		switch (type)
+		{
+		case InputEventType::Frame:
+			read(frame.deltaTime);
+			read(frame.movement);
+			mFrames.push_back(std::move(frame));
+			frame = InputFrame{};
+			break;
+		case InputEventType::Key:
+		{
+			double time;
+			int16_t key;
+			uint8_t action, mods;
+			read(time);
+			read(key);
+			read(action);
+			read(mods);
+			frame.events.push_back({ type, time, key, action, mods, 0.0, 0.0 });
+			lastTime = time;
+			events++;
+			break;
+		}
+		case InputEventType::Cursor:
+		{
+			double time, x, y;
+			read(time);
+			read(x);
+			read(y);
+			frame.events.push_back({ type, time, 0, 0, 0, x, y });
+			lastTime = time;
+			events++;
+			break;
+		}
+		default:
+			throw std::runtime_error("Input recording is corrupt! (" + fileName + ")");
+		}
+	}
+
+	if (mFrames.empty())
+		throw std::runtime_error("Input recording has no frames! (" + fileName + ")");
+
+	// Events after the last frame were never acted on while recording.
+	std::cout << "Input replay " << fileName << ": " << mFrames.size() << " frames, " << events << " events over " << lastTime << " s\n";
+}
\ No newline at end of file
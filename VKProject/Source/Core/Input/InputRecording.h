@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+enum class InputEventType : uint8_t
+{
+	Frame,
+	Key,
+	Cursor
+};
+
+struct InputEvent
+{
+	InputEventType type;
+	// Seconds since the recording was opened. Replays step by frame, so this only places events in the session.
+	double time;
+	int32_t key;
+	int32_t action;
+	int32_t mods;
+	double x;
+	double y;
+};
+
+// Everything that happened before one frame's camera update, plus the movement keys and timestep it used.
+struct InputFrame
+{
+	float deltaTime = 0.0f;
+	uint8_t movement = 0;
+	std::vector<InputEvent> events;
+};
+
+// Writes timestamped key and cursor events as they arrive and closes each frame with its timestep and movement keys,
+// so a replay steps the camera through exactly the same poses. Records are a one byte type followed by packed fields
+// in host byte order, which is little-endian on every platform this builds for.
+class InputRecorder
+{
+public:
+	~InputRecorder();
+
+	void Open(const std::string& fileName);
+	void Close();
+
+	bool IsOpen() const { return mFile.is_open(); }
+
+	void RecordKey(int key, int action, int mods);
+	void RecordCursor(double x, double y);
+	void EndFrame(float deltaTime, uint8_t movement);
+private:
+	template<typename T>
+	void write(T value) { mFile.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+	std::string mFileName;
+	std::ofstream mFile;
+	std::chrono::steady_clock::time_point mStart;
+	uint64_t mFrames = 0;
+	uint64_t mEvents = 0;
+};
+
+// Reads a whole recording up front and hands it out one frame at a time.
+class InputReplay
+{
+public:
+	// Throws for a recording that is truncated or has no frames, rather than leaving the run without input to replay.
+	void Load(const std::string& fileName);
+
+	bool IsLoaded() const { return !mFrames.empty(); }
+	uint32_t GetFrameCount() const { return static_cast<uint32_t>(mFrames.size()); }
+
+	// Null once the recording is exhausted.
+	const InputFrame* Next() { return mNext < mFrames.size() ? &mFrames[mNext++] : nullptr; }
+private:
+	std::vector<InputFrame> mFrames;
+	size_t mNext = 0;
+};
+
+#endif
\ No newline at end of file
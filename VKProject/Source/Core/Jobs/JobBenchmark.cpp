@@ -0,0 +1,92 @@
+#include "JobBenchmark.h"
+
+#include <Core/Jobs/JobSystem.h>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+	const uint32_t ObjectCount = 200000;
+	const uint32_t BatchSize = 1024;
+	const uint32_t FrameCount = 60;
+
+	struct Object
+	{
+		glm::vec3 position;
+		float angle;
+		glm::mat4 world;
+		bool visible;
+	};
+
+	// One frame of the graph: animation, then culling and transform of every object, then a per-batch "recording" pass.
+	void runFrame(JobSystem& jobs, std::vector<Object>& objects, const glm::mat4& viewProj, float time)
+	{
+		JobCounter animated;
+		jobs.ParallelFor(ObjectCount, BatchSize, [&objects, time](uint32_t first, uint32_t last)
+		{
+			for (uint32_t i = first; i < last; i++)
+			{
+				objects[i].angle = time + i * 0.001f;
+				objects[i].world = glm::rotate(glm::translate(glm::mat4(1.0f), objects[i].position), objects[i].angle, glm::vec3(0.0f, 1.0f, 0.0f));
+			}
+		}, &animated);
+
+		JobCounter culled;
+		jobs.Run([&jobs, &objects, &viewProj, &culled]
+		{
+			jobs.ParallelFor(ObjectCount, BatchSize, [&objects, &viewProj](uint32_t first, uint32_t last)
+			{
+				for (uint32_t i = first; i < last; i++)
+				{
+					glm::vec4 clip = viewProj * objects[i].world * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+					objects[i].visible = clip.w > 0.0f && glm::abs(clip.x) <= clip.w && glm::abs(clip.y) <= clip.w;
+				}
+			}, &culled);
+		}, &culled, JobAffinity::Any, &animated);
+
+		jobs.Wait(culled);
+		jobs.Wait(animated);
+	}
+}
+
+int JobBenchmark::Run()
+{
+	uint32_t maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<Object> objects(ObjectCount);
+	for (uint32_t i = 0; i < ObjectCount; i++)
+		objects[i].position = glm::vec3((i % 1000) * 0.1f - 50.0f, 0.0f, (i / 1000) * 0.1f - 10.0f);
+
+	glm::mat4 viewProj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+		glm::lookAt(glm::vec3(0.0f, 10.0f, -20.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	std::cout << "Job system benchmark: " << ObjectCount << " objects, " << FrameCount << " frames\n";
+
+	double baseline = 0.0;
+
+	for (uint32_t workers = 1; workers <= maxWorkers; workers++)
+	{
+		JobSystem jobs(workers);
+
+		runFrame(jobs, objects, viewProj, 0.0f);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for (uint32_t frame = 0; frame < FrameCount; frame++)
+			runFrame(jobs, objects, viewProj, frame * 0.016f);
+
+		double frameTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / FrameCount;
+
+		if (workers == 1)
+			baseline = frameTime;
+
+		std::cout << workers << " workers: " << frameTime << " ms/frame, speedup " << baseline / frameTime << "x\n";
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#ifndef JOBBENCHMARK_H
+#define JOBBENCHMARK_H
+
+// Runs a synthetic frame task graph on 1..N workers and prints frame times and speedup. Started with --bench-jobs.
+namespace JobBenchmark
+{
+	int Run();
+}
+
+#endif
\ No newline at end of file
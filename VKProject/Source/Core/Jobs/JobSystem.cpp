@@ -0,0 +1,237 @@
+#include "JobSystem.h"
+
+#include <Core/Profiling/Profiler.h>
+
+namespace
+{
+	thread_local const JobSystem* tJobSystem = nullptr;
+	thread_local uint32_t tWorker = 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+	workerCount = std::max(workerCount, 1u);
+
+	for (uint32_t i = 0; i < workerCount; i++)
+		mQueues.push_back(std::make_unique<Queue>());
+
+	SetMainThread();
+
+	for (uint32_t i = 1; i < workerCount; i++)
+		mThreads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mQuit = true;
+	}
+
+	mWake.notify_all();
+
+	for (auto& thread : mThreads)
+		thread.join();
+
+	if (tJobSystem == this)
+		tJobSystem = nullptr;
+}
+
+uint32_t JobSystem::GetCurrentWorker() const
+{
+	return tJobSystem == this ? tWorker : 0;
+}
+
+void JobSystem::SetMainThread()
+{
+	tJobSystem = this;
+	tWorker = 0;
+
+	mMainThread.store(std::this_thread::get_id(), std::memory_order_release);
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter, JobAffinity affinity, JobCounter* dependency)
+{
+	Job job;
+	job.function = std::move(function);
+	job.counter = counter;
+	job.affinity = affinity;
+
+	if (counter)
+		counter->mValue.fetch_add(1, std::memory_order_relaxed);
+
+	if (dependency)
+	{
+		std::lock_guard<std::mutex> lock(dependency->mMutex);
+
+		if (dependency->mValue.load(std::memory_order_acquire) != 0)
+		{
+			dependency->mWaiting.push_back(std::move(job));
+			return;
+		}
+	}
+
+	push(std::move(job));
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)>& function, JobCounter* counter)
+{
+	batchSize = std::max(batchSize, 1u);
+
+	for (uint32_t first = 0; first < count; first += batchSize)
+	{
+		uint32_t last = std::min(first + batchSize, count);
+		Run([function, first, last] { function(first, last); }, counter);
+	}
+}
+
+void JobSystem::push(Job job)
+{
+	if (job.affinity == JobAffinity::MainThread)
+	{
+		std::lock_guard<std::mutex> lock(mMainQueue.mutex);
+		mMainQueue.jobs.push_back(std::move(job));
+		return;
+	}
+
+	if (job.affinity == JobAffinity::Background)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mBackgroundQueue.mutex);
+			mBackgroundQueue.jobs.push_back(std::move(job));
+		}
+
+		mBackgroundQueued.fetch_add(1, std::memory_order_release);
+	}
+	else
+	{
+		Queue& queue = *mQueues[GetCurrentWorker()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(std::move(job));
+		}
+
+		mQueued.fetch_add(1, std::memory_order_release);
+	}
+
+	// Taking the lock orders the notify after a sleeping worker's predicate check, so the wake up cannot be lost.
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+	}
+	mWake.notify_one();
+}
+
+bool JobSystem::tryGetJob(uint32_t worker, Job& job)
+{
+	if (worker == 0 && std::this_thread::get_id() == mMainThread.load(std::memory_order_acquire))
+	{
+		std::lock_guard<std::mutex> lock(mMainQueue.mutex);
+		if (!mMainQueue.jobs.empty())
+		{
+			job = std::move(mMainQueue.jobs.front());
+			mMainQueue.jobs.pop_front();
+			return true;
+		}
+	}
+
+	{
+		Queue& own = *mQueues[worker];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty())
+		{
+			job = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			mQueued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	uint32_t count = GetWorkerCount();
+	for (uint32_t i = 1; i < count; i++)
+	{
+		Queue& victim = *mQueues[(worker + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty())
+		{
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			mQueued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// Background work is picked up last, and by the main thread only when it is the only worker.
+	if (worker != 0 || count == 1)
+	{
+		std::lock_guard<std::mutex> lock(mBackgroundQueue.mutex);
+		if (!mBackgroundQueue.jobs.empty())
+		{
+			job = std::move(mBackgroundQueue.jobs.front());
+			mBackgroundQueue.jobs.pop_front();
+			mBackgroundQueued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::execute(Job& job)
+{
+	job.function();
+
+	JobCounter* counter = job.counter;
+	if (!counter)
+		return;
+
+	std::vector<Job> ready;
+	{
+		std::lock_guard<std::mutex> lock(counter->mMutex);
+		if (counter->mValue.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			ready.swap(counter->mWaiting);
+	}
+
+	for (auto& waiting : ready)
+		push(std::move(waiting));
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	uint32_t worker = GetCurrentWorker();
+
+	while (!counter.IsDone())
+	{
+		Job job;
+		if (tryGetJob(worker, job))
+			execute(job);
+		else
+			std::this_thread::yield();
+	}
+
+	// The finishing job may still hold the counter's mutex; the counter must not be destroyed before it lets go.
+	std::lock_guard<std::mutex> lock(counter.mMutex);
+}
+
+void JobSystem::workerLoop(uint32_t worker)
+{
+	tJobSystem = this;
+	tWorker = worker;
+
+	Profiler::Get().SetThreadName("Job worker " + std::to_string(worker));
+
+	while (true)
+	{
+		Job job;
+		if (tryGetJob(worker, job))
+		{
+			execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mWake.wait(lock, [this] { return mQuit || mQueued.load(std::memory_order_acquire) > 0 || mBackgroundQueued.load(std::memory_order_acquire) > 0; });
+
+		if (mQuit)
+			return;
+	}
+}
\ No newline at end of file
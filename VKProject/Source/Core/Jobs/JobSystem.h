@@ -0,0 +1,101 @@
+#pragma once
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+enum class JobAffinity
+{
+	Any,
+	// Only the main thread runs these, from inside Wait(): the thread that created the JobSystem, or the one that took
+	// over with SetMainThread (the render thread when RENDER_THREAD is on). Use for ImGui calls, and for GLFW calls
+	// only while the main thread is the one that owns the window.
+	MainThread,
+	// Long running work such as pipeline compilation. The main thread never picks these up while there are other
+	// workers, so waiting on frame jobs is not stalled behind them.
+	Background
+};
+
+struct Job
+{
+	std::function<void()> function;
+	JobCounter* counter = nullptr;
+	JobAffinity affinity = JobAffinity::Any;
+};
+
+// Number of unfinished jobs that were started with it. Jobs started with a counter as their dependency
+// are held back until it reaches zero.
+class JobCounter
+{
+public:
+	bool IsDone() const { return mValue.load(std::memory_order_acquire) == 0; }
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> mValue{ 0 };
+	std::mutex mMutex;
+	std::vector<Job> mWaiting;
+};
+
+// Work stealing scheduler. Every worker owns a deque: it pushes and pops its own work at the back and idle
+// workers steal from the front of the others. Worker 0 is the main thread, which only runs jobs from Wait(). Other
+// threads that are not workers share its queue but never pick up MainThread jobs.
+class JobSystem
+{
+public:
+	explicit JobSystem(uint32_t workerCount);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	uint32_t GetWorkerCount() const { return static_cast<uint32_t>(mQueues.size()); }
+	// Index of the calling thread in this system, 0 for threads that are not workers.
+	uint32_t GetCurrentWorker() const;
+
+	// Makes the calling thread the one that runs MainThread jobs, in place of the creating thread.
+	void SetMainThread();
+
+	void Run(std::function<void()> function, JobCounter* counter = nullptr, JobAffinity affinity = JobAffinity::Any, JobCounter* dependency = nullptr);
+	// Splits [0, count) into batches of batchSize and runs function(first, last) for each of them.
+	void ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)>& function, JobCounter* counter);
+
+	// Runs other jobs until the counter reaches zero, so waiting from inside a job cannot deadlock the pool.
+	void Wait(JobCounter& counter);
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	void push(Job job);
+	bool tryGetJob(uint32_t worker, Job& job);
+	void execute(Job& job);
+	void workerLoop(uint32_t worker);
+
+	std::vector<std::unique_ptr<Queue>> mQueues;
+	Queue mMainQueue;
+	Queue mBackgroundQueue;
+
+	std::vector<std::thread> mThreads;
+	std::atomic<std::thread::id> mMainThread;
+
+	std::atomic<uint32_t> mQueued{ 0 };
+	std::atomic<uint32_t> mBackgroundQueued{ 0 };
+	std::mutex mSleepMutex;
+	std::condition_variable mWake;
+	bool mQuit = false;
+};
+
+#endif
\ No newline at end of file
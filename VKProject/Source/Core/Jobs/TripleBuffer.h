@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free hand-off of the newest value from one writer thread to one reader thread. The writer fills its own slot
+// and publishes it by swapping it with the middle one; the reader swaps the middle one in when it is newer than what
+// it holds. Neither side ever waits, and the reader skips values it was too slow to see.
+template<typename T>
+class TripleBuffer
+{
+public:
+	// Writer side.
+	T& Write() { return mSlots[mBack]; }
+	void Publish() { mBack = mMiddle.exchange(mBack | FreshBit, std::memory_order_acq_rel) & IndexMask; }
+
+	// Reader side. Returns false when nothing newer was published since the last call.
+	bool Update()
+	{
+		if ((mMiddle.load(std::memory_order_relaxed) & FreshBit) == 0)
+			return false;
+
+		mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & IndexMask;
+		return true;
+	}
+
+	const T& Read() const { return mSlots[mFront]; }
+private:
+	static const uint32_t FreshBit = 4;
+	static const uint32_t IndexMask = 3;
+
+	T mSlots[3]{};
+	uint32_t mBack = 0;
+	std::atomic<uint32_t> mMiddle{ 1 };
+	uint32_t mFront = 2;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> sAllocationCount{ 0 };
+static std::atomic<uint64_t> sAllocationBytes{ 0 };
+
+uint64_t AllocationCounter::GetCount()
+{
+	return sAllocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::GetBytes()
+{
+	return sAllocationBytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+	sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	sAllocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+	if (void* memory = std::malloc(size ? size : 1))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
\ No newline at end of file
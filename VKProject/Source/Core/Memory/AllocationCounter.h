@@ -0,0 +1,15 @@
+#pragma once
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+// Counts calls to the global operator new so per-frame heap churn can be measured.
+namespace AllocationCounter
+{
+	uint64_t GetCount();
+	uint64_t GetBytes();
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "FrameArena.h"
+
+FrameArena::FrameArena(size_t capacity)
+	: mBuffer(new char[capacity]), mCapacity(capacity)
+{
+}
+
+void FrameArena::Reset()
+{
+	if (!mOverflow.empty())
+	{
+		mOverflow.clear();
+		mCapacity = mUsed + mUsed / 2;
+		mBuffer.reset(new char[mCapacity]);
+	}
+
+	mOffset = 0;
+	mUsed = 0;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment)
+{
+	uintptr_t base = reinterpret_cast<uintptr_t>(mBuffer.get());
+	uintptr_t address = (base + mOffset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+
+	mUsed += bytes;
+
+	if (address + bytes <= base + mCapacity)
+	{
+		mOffset = address + bytes - base;
+		return reinterpret_cast<void*>(address);
+	}
+
+	// Out of space for this frame: fall back to a dedicated block and size the arena up on the next Reset().
+	mOverflow.emplace_back(new char[bytes + alignment]);
+
+	uintptr_t overflow = reinterpret_cast<uintptr_t>(mOverflow.back().get());
+	return reinterpret_cast<void*>((overflow + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Linear allocator for CPU temporaries that only live for one frame. Allocations are a pointer bump,
+// deallocation is a no-op and everything is released at once by Reset() after the frame's fence signals.
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+	explicit FrameArena(size_t capacity = 256 * 1024);
+
+	// Grows the main block to last frame's high water mark if the frame had to spill into overflow blocks.
+	void Reset();
+
+	size_t GetUsed() const { return mUsed; }
+	size_t GetCapacity() const { return mCapacity; }
+	size_t GetOverflowCount() const { return mOverflow.size(); }
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* /*p*/, size_t /*bytes*/, size_t /*alignment*/) override {}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	std::unique_ptr<char[]> mBuffer;
+	size_t mCapacity = 0;
+	size_t mOffset = 0;
+	size_t mUsed = 0;
+
+	std::vector<std::unique_ptr<char[]>> mOverflow;
+};
+
+#endif
\ No newline at end of file
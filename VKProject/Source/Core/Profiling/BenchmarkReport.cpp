@@ -0,0 +1,106 @@
+#include "BenchmarkReport.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+void BenchmarkReport::AddCpuFrame(uint64_t frameNumber, double ms)
+{
+	if (frameNumber >= mWarmupFrames)
+		mCpuFrames.push_back(ms);
+}
+
+void BenchmarkReport::AddGpuFrame(uint64_t frameNumber, double ms)
+{
+	if (frameNumber >= mWarmupFrames)
+		mGpuFrames.push_back(ms);
+}
+
+FrameTimeSummary BenchmarkReport::Summarize(std::vector<double> samples)
+{
+	FrameTimeSummary summary;
+	summary.count = samples.size();
+
+	if (samples.empty())
+		return summary;
+
+	std::sort(samples.begin(), samples.end());
+
+	// Nearest rank, so every reported percentile is a frame that actually happened.
+	auto percentile = [&samples](double p)
+	{
+		size_t rank = static_cast<size_t>(p / 100.0 * samples.size() + 0.999999);
+		return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+	};
+
+	summary.minMs = samples.front();
+	summary.maxMs = samples.back();
+	summary.meanMs = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+	summary.p50Ms = percentile(50.0);
+	summary.p95Ms = percentile(95.0);
+	summary.p99Ms = percentile(99.0);
+
+	return summary;
+}
+
+void BenchmarkReport::Write(const std::string& jsonFile, const std::string& csvFile, const std::map<std::string, uint32_t>& settings, const std::string& input) const
+{
+	FrameTimeSummary cpu = Summarize(mCpuFrames);
+	FrameTimeSummary gpu = Summarize(mGpuFrames);
+
+	std::ofstream json(jsonFile);
+
+	if (!json.is_open())
+		throw std::runtime_error("Failed to open file! (" + jsonFile + ")");
+
+	auto writeSummary = [&json](const char* name, const FrameTimeSummary& s, bool last)
+	{
+		json << "\t\t\"" << name << "\": { \"frames\": " << s.count << ", \"min\": " << s.minMs << ", \"mean\": " << s.meanMs << ", \"p50\": " << s.p50Ms
+			<< ", \"p95\": " << s.p95Ms << ", \"p99\": " << s.p99Ms << ", \"max\": " << s.maxMs << " }" << (last ? "\n" : ",\n");
+	};
+
+	json << std::fixed << std::setprecision(4);
+	json << "{\n\t\"input\": \"" << input << "\",\n\t\"warmupFrames\": " << mWarmupFrames << ",\n\t\"settings\": {\n";
+
+	size_t i = 0;
+	for (const auto& setting : settings)
+		json << "\t\t\"" << setting.first << "\": " << setting.second << (++i < settings.size() ? ",\n" : "\n");
+
+	json << "\t},\n\t\"frameTimeMs\": {\n";
+	writeSummary("cpu", cpu, false);
+	writeSummary("gpu", gpu, true);
+	json << "\t}\n}\n";
+
+	std::ofstream csv(csvFile);
+
+	if (!csv.is_open())
+		throw std::runtime_error("Failed to open file! (" + csvFile + ")");
+
+	csv << std::fixed << std::setprecision(4);
+	csv << "series,frames,min_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+	csv << "cpu," << cpu.count << ',' << cpu.minMs << ',' << cpu.meanMs << ',' << cpu.p50Ms << ',' << cpu.p95Ms << ',' << cpu.p99Ms << ',' << cpu.maxMs << '\n';
+	csv << "gpu," << gpu.count << ',' << gpu.minMs << ',' << gpu.meanMs << ',' << gpu.p50Ms << ',' << gpu.p95Ms << ',' << gpu.p99Ms << ',' << gpu.maxMs << '\n';
+
+	std::cout << "Benchmark report written to " << jsonFile << " and " << csvFile << '\n';
+}
+
+void BenchmarkReport::Print() const
+{
+	auto print = [](const char* name, const FrameTimeSummary& s)
+	{
+		if (s.count == 0)
+		{
+			std::cout << "Benchmark " << name << ": no samples\n";
+			return;
+		}
+
+		std::cout << "Benchmark " << name << " frame time over " << s.count << " frames: min " << s.minMs << " ms, mean " << s.meanMs << " ms, p50 "
+			<< s.p50Ms << " ms, p95 " << s.p95Ms << " ms, p99 " << s.p99Ms << " ms\n";
+	};
+
+	print("CPU", Summarize(mCpuFrames));
+	print("GPU", Summarize(mGpuFrames));
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef BENCHMARKREPORT_H
+#define BENCHMARKREPORT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct FrameTimeSummary
+{
+	size_t count = 0;
+	double minMs = 0.0;
+	double meanMs = 0.0;
+	double p50Ms = 0.0;
+	double p95Ms = 0.0;
+	double p99Ms = 0.0;
+	double maxMs = 0.0;
+};
+
+// Frame times of a benchmark run. The first warmup frames are dropped so pipeline compiles and first uploads do not
+// skew the result. Written as JSON together with the settings of the run, and as CSV, one row per series.
+class BenchmarkReport
+{
+public:
+	explicit BenchmarkReport(uint32_t warmupFrames = 0) : mWarmupFrames(warmupFrames) {}
+
+	void AddCpuFrame(uint64_t frameNumber, double ms);
+	void AddGpuFrame(uint64_t frameNumber, double ms);
+
+	static FrameTimeSummary Summarize(std::vector<double> samples);
+
+	void Write(const std::string& jsonFile, const std::string& csvFile, const std::map<std::string, uint32_t>& settings, const std::string& input) const;
+	void Print() const;
+private:
+	uint32_t mWarmupFrames;
+
+	std::vector<double> mCpuFrames;
+	std::vector<double> mGpuFrames;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "FrameStatistics.h"
+
+#include <ImGui/imgui.h>
+
+#include <algorithm>
+#include <iostream>
+
+DrawCounters& DrawCounters::operator+=(const DrawCounters& other)
+{
+	draws += other.draws;
+	triangles += other.triangles;
+	instances += other.instances;
+	descriptorBinds += other.descriptorBinds;
+	pipelineBinds += other.pipelineBinds;
+	uploadBytes += other.uploadBytes;
+
+	return *this;
+}
+
+void FrameStatistics::EnableFeatures(const VkPhysicalDeviceFeatures& supported, VkPhysicalDeviceFeatures& enabled)
+{
+	if (supported.pipelineStatisticsQuery && supported.inheritedQueries)
+	{
+		enabled.pipelineStatisticsQuery = VK_TRUE;
+		enabled.inheritedQueries = VK_TRUE;
+	}
+}
+
+void FrameStatistics::Init(const VkPhysicalDeviceFeatures& enabled, uint32_t framesInFlight)
+{
+	mSlots.assign(framesInFlight, Slot{});
+
+	if (!enabled.pipelineStatisticsQuery || !enabled.inheritedQueries)
+	{
+		std::cout << "Pipeline statistics queries are not supported, only CPU draw counters are collected\n";
+		return;
+	}
+
+	VkQueryPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+	poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	poolInfo.queryCount = framesInFlight;
+	poolInfo.pipelineStatistics = QueryFlags;
+
+	if (vkCreateQueryPool(mDevice, &poolInfo, HostAllocator::Get().Callbacks(), mQueryPool.replace(mDevice)) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create pipeline statistics query pool!");
+}
+
+void FrameStatistics::OpenCsv(const std::string& fileName)
+{
+	mCsv.open(fileName);
+
+	if (!mCsv.is_open())
+		throw std::runtime_error("Failed to open file! (" + fileName + ")");
+
+	mCsv << "frame,draws,triangles,instances,descriptor_binds,pipeline_binds,upload_bytes,"
+		"input_primitives,vertex_invocations,clipping_invocations,clipping_primitives,fragment_invocations\n";
+
+	std::cout << "Frame statistics are logged to " << fileName << '\n';
+}
+
+void FrameStatistics::finish(Slot& slot, uint32_t frame)
+{
+	if (!slot.pending)
+		return;
+
+	slot.pending = false;
+
+	// Five statistics in bit order plus availability. Without the wait bit this never blocks.
+	uint64_t data[6] = {};
+	bool available = false;
+
+	if (slot.queried)
+	{
+		VkResult result = vkGetQueryPoolResults(mDevice, mQueryPool, frame, 1, sizeof(data), data, sizeof(data),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+		available = result == VK_SUCCESS && data[5] != 0;
+	}
+
+	if (available)
+	{
+		mLastStatistics.inputPrimitives = data[0];
+		mLastStatistics.vertexInvocations = data[1];
+		mLastStatistics.clippingInvocations = data[2];
+		mLastStatistics.clippingPrimitives = data[3];
+		mLastStatistics.fragmentInvocations = data[4];
+		mStatisticsValid = true;
+	}
+
+	if (!mCsv.is_open())
+		return;
+
+	const DrawCounters& c = slot.counters;
+	mCsv << slot.frameNumber << ',' << c.draws << ',' << c.triangles << ',' << c.instances << ',' << c.descriptorBinds << ',' << c.pipelineBinds << ',' << c.uploadBytes;
+
+	if (available)
+	{
+		for (uint32_t i = 0; i < 5; i++)
+			mCsv << ',' << data[i];
+	}
+	else
+	{
+		mCsv << ",,,,,";
+	}
+
+	mCsv << '\n';
+}
+
+void FrameStatistics::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame, uint64_t frameNumber, const DrawCounters& counters)
+{
+	Slot& slot = mSlots[frame];
+
+	finish(slot, frame);
+
+	slot.counters = counters;
+	slot.counters.uploadBytes += mUploadBytes.exchange(0, std::memory_order_relaxed);
+	slot.frameNumber = frameNumber;
+	slot.pending = true;
+	slot.queried = false;
+
+	mLastCounters = slot.counters;
+	mCurrent = frame;
+
+	if (mQueryPool != VK_NULL_HANDLE)
+		vkCmdResetQueryPool(commandBuffer, mQueryPool, frame, 1);
+}
+
+void FrameStatistics::Finish()
+{
+	std::vector<uint32_t> order;
+	for (uint32_t i = 0; i < mSlots.size(); i++)
+	{
+		if (mSlots[i].pending)
+			order.push_back(i);
+	}
+
+	std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return mSlots[a].frameNumber < mSlots[b].frameNumber; });
+
+	for (uint32_t frame : order)
+		finish(mSlots[frame], frame);
+
+	mCsv.flush();
+}
+
+void FrameStatistics::BeginQuery(VkCommandBuffer commandBuffer)
+{
+	if (mQueryPool == VK_NULL_HANDLE)
+		return;
+
+	vkCmdBeginQuery(commandBuffer, mQueryPool, mCurrent, 0);
+	mSlots[mCurrent].queried = true;
+}
+
+void FrameStatistics::EndQuery(VkCommandBuffer commandBuffer)
+{
+	if (mQueryPool == VK_NULL_HANDLE)
+		return;
+
+	vkCmdEndQuery(commandBuffer, mQueryPool, mCurrent);
+}
+
+void FrameStatistics::DrawPanel()
+{
+	ImGui::Begin("Frame statistics");
+
+	ImGui::Text("Draws: %llu, instances: %llu", static_cast<unsigned long long>(mLastCounters.draws), static_cast<unsigned long long>(mLastCounters.instances));
+	ImGui::Text("Triangles submitted: %llu", static_cast<unsigned long long>(mLastCounters.triangles));
+	ImGui::Text("Pipeline binds: %llu, descriptor binds: %llu", static_cast<unsigned long long>(mLastCounters.pipelineBinds), static_cast<unsigned long long>(mLastCounters.descriptorBinds));
+	ImGui::Text("Uploaded: %llu bytes", static_cast<unsigned long long>(mLastCounters.uploadBytes));
+
+	ImGui::Separator();
+
+	if (!mStatisticsValid)
+	{
+		ImGui::Text("Pipeline statistics %s", mQueryPool != VK_NULL_HANDLE ? "pending" : "not supported");
+	}
+	else
+	{
+		ImGui::Text("Input primitives: %llu", static_cast<unsigned long long>(mLastStatistics.inputPrimitives));
+		ImGui::Text("Vertex invocations: %llu (%.2f per triangle)", static_cast<unsigned long long>(mLastStatistics.vertexInvocations),
+			mLastStatistics.inputPrimitives ? static_cast<double>(mLastStatistics.vertexInvocations) / mLastStatistics.inputPrimitives : 0.0);
+		ImGui::Text("Clipping invocations: %llu, primitives out: %llu", static_cast<unsigned long long>(mLastStatistics.clippingInvocations), static_cast<unsigned long long>(mLastStatistics.clippingPrimitives));
+		ImGui::Text("Fragment invocations: %llu", static_cast<unsigned long long>(mLastStatistics.fragmentInvocations));
+	}
+
+	ImGui::End();
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#ifndef FRAMESTATISTICS_H
+#define FRAMESTATISTICS_H
+
+#include <Core/Vulkan/VkHandle.h>
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// What the CPU put into a frame. Recording jobs each fill their own and the results are summed.
+struct DrawCounters
+{
+	uint64_t draws = 0;
+	uint64_t triangles = 0;
+	uint64_t instances = 0;
+	uint64_t descriptorBinds = 0;
+	uint64_t pipelineBinds = 0;
+	uint64_t uploadBytes = 0;
+
+	DrawCounters& operator+=(const DrawCounters& other);
+};
+
+// What the GPU did with it, from VK_QUERY_TYPE_PIPELINE_STATISTICS.
+struct PipelineStatistics
+{
+	uint64_t inputPrimitives = 0;
+	uint64_t vertexInvocations = 0;
+	uint64_t clippingInvocations = 0;
+	uint64_t clippingPrimitives = 0;
+	uint64_t fragmentInvocations = 0;
+};
+
+// Per-frame draw counters plus pipeline statistics for the scene pass where the device has them. Statistics are read
+// back when the frame slot comes around again, so they lag the counters by the frames in flight and never stall.
+// Both are shown in an ImGui panel and can be logged to CSV, one row per frame.
+class FrameStatistics
+{
+public:
+	FrameStatistics(const DeviceHandle& device) : mDevice(device) {}
+
+	// The scene is drawn from secondary command buffers, so statistics need inheritedQueries as well.
+	static void EnableFeatures(const VkPhysicalDeviceFeatures& supported, VkPhysicalDeviceFeatures& enabled);
+
+	void Init(const VkPhysicalDeviceFeatures& enabled, uint32_t framesInFlight);
+	void OpenCsv(const std::string& fileName);
+
+	// Inheritance flags for secondary command buffers recorded while the statistics query is active.
+	VkQueryPipelineStatisticFlags GetQueryFlags() const { return mQueryPool != VK_NULL_HANDLE ? QueryFlags : 0; }
+
+	// Staging copies and per-frame writes to mapped memory, from any thread. Added to the next frame.
+	void AddUpload(VkDeviceSize bytes) { mUploadBytes.fetch_add(bytes, std::memory_order_relaxed); }
+
+	// Finishes the frame this slot recorded last time, then starts a new one with the given counters. Outside a render pass.
+	void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame, uint64_t frameNumber, const DrawCounters& counters);
+
+	// Writes the frames still in flight once the device is idle.
+	void Finish();
+
+	void BeginQuery(VkCommandBuffer commandBuffer);
+	void EndQuery(VkCommandBuffer commandBuffer);
+
+	void DrawPanel();
+private:
+	static const VkQueryPipelineStatisticFlags QueryFlags =
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+	struct Slot
+	{
+		DrawCounters counters;
+		uint64_t frameNumber = 0;
+		bool pending = false;
+		bool queried = false;
+	};
+
+	void finish(Slot& slot, uint32_t frame);
+
+	const DeviceHandle& mDevice;
+	VkHandle<VkQueryPool, vkDestroyQueryPool> mQueryPool;
+
+	std::vector<Slot> mSlots;
+	uint32_t mCurrent = 0;
+
+	std::atomic<uint64_t> mUploadBytes{ 0 };
+
+	DrawCounters mLastCounters;
+	PipelineStatistics mLastStatistics;
+	bool mStatisticsValid = false;
+
+	std::ofstream mCsv;
+};
+
+#endif
\ No newline at end of file
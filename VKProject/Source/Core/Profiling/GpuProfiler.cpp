@@ -0,0 +1,220 @@
+#include "GpuProfiler.h"
+
+#include <Core/Profiling/Profiler.h>
+
+#include <ImGui/imgui.h>
+
+#include <algorithm>
+#include <iostream>
+
+void GpuProfiler::Init(VkPhysicalDevice physDevice, uint32_t queueFamily, uint32_t framesInFlight)
+{
+	uint32_t familyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physDevice, &familyCount, nullptr);
+
+	std::vector<VkQueueFamilyProperties> families(familyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physDevice, &familyCount, families.data());
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physDevice, &properties);
+
+	uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+
+	if (validBits == 0 || properties.limits.timestampPeriod == 0.0f)
+	{
+		std::cout << "GPU timestamps are not supported on this queue, GPU profiling is disabled\n";
+		return;
+	}
+
+	mTimestampPeriod = properties.limits.timestampPeriod;
+	mTimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+	// One block per frame in flight plus one for one-off command buffers.
+	mBlocks.resize(framesInFlight + 1);
+	for (uint32_t i = 0; i < mBlocks.size(); i++)
+		mBlocks[i].firstQuery = i * MaxScopes * 2;
+
+	VkQueryPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+	poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	poolInfo.queryCount = static_cast<uint32_t>(mBlocks.size()) * MaxScopes * 2;
+
+	if (vkCreateQueryPool(mDevice, &poolInfo, HostAllocator::Get().Callbacks(), mQueryPool.replace(mDevice)) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create timestamp query pool!");
+}
+
+void GpuProfiler::reset(VkCommandBuffer commandBuffer, Block& block)
+{
+	vkCmdResetQueryPool(commandBuffer, mQueryPool, block.firstQuery, MaxScopes * 2);
+
+	block.usedQueries = 0;
+	block.anchor = 0;
+	block.scopes.clear();
+	block.open.clear();
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+	if (!IsSupported())
+		return;
+
+	Block& block = mBlocks[frame];
+
+	collect(block, true);
+	reset(commandBuffer, block);
+
+	mCurrent = &block;
+}
+
+void GpuProfiler::Submit()
+{
+	if (mCurrent)
+		mCurrent->anchor = Profiler::Now();
+}
+
+void GpuProfiler::BeginImmediate(VkCommandBuffer commandBuffer)
+{
+	if (!IsSupported())
+		return;
+
+	mInterrupted = mCurrent;
+	mCurrent = &mBlocks.back();
+
+	reset(commandBuffer, *mCurrent);
+}
+
+void GpuProfiler::EndImmediate()
+{
+	if (!IsSupported())
+		return;
+
+	collect(mBlocks.back(), false);
+
+	mCurrent = mInterrupted;
+	mInterrupted = nullptr;
+}
+
+void GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char* name)
+{
+	if (!mCurrent)
+		return;
+
+	Block& block = *mCurrent;
+
+	// Scopes past the limit are dropped; their EndScope pops a placeholder.
+	if (block.usedQueries + 2 > MaxScopes * 2)
+	{
+		block.open.push_back(UINT32_MAX);
+		return;
+	}
+
+	uint32_t query = block.firstQuery + block.usedQueries;
+	block.usedQueries += 2;
+
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mQueryPool, query);
+
+	block.open.push_back(static_cast<uint32_t>(block.scopes.size()));
+	block.scopes.push_back({ name, static_cast<uint32_t>(block.open.size() - 1), query });
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer commandBuffer)
+{
+	if (!mCurrent || mCurrent->open.empty())
+		return;
+
+	Block& block = *mCurrent;
+
+	uint32_t scope = block.open.back();
+	block.open.pop_back();
+
+	if (scope != UINT32_MAX)
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mQueryPool, block.scopes[scope].query + 1);
+}
+
+void GpuProfiler::collect(Block& block, bool frame)
+{
+	if (block.usedQueries == 0 || block.anchor == 0)
+		return;
+
+	// Value and availability per query. Without the wait bit this never blocks; a block that is not done yet is skipped.
+	std::vector<uint64_t> data(block.usedQueries * 2);
+
+	VkResult result = vkGetQueryPoolResults(mDevice, mQueryPool, block.firstQuery, block.usedQueries, data.size() * sizeof(uint64_t), data.data(),
+		2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	bool available = result == VK_SUCCESS;
+	for (uint32_t i = 0; i < block.usedQueries && available; i++)
+		available = data[i * 2 + 1] != 0;
+
+	if (!available)
+	{
+		mLateFrames++;
+		return;
+	}
+
+	auto timestamp = [&](uint32_t query) { return data[(query - block.firstQuery) * 2] & mTimestampMask; };
+
+	uint64_t origin = timestamp(block.scopes.front().query);
+	for (const Scope& scope : block.scopes)
+		origin = std::min(origin, timestamp(scope.query));
+
+	if (frame)
+	{
+		mLastFrame.clear();
+		mLastFrameMs = 0.0;
+		mCollectedFrames++;
+	}
+
+	for (const Scope& scope : block.scopes)
+	{
+		uint64_t begin = timestamp(scope.query);
+		uint64_t end = std::max(begin, timestamp(scope.query + 1));
+
+		double beginUs = (begin - origin) * mTimestampPeriod / 1000.0;
+		double endUs = (end - origin) * mTimestampPeriod / 1000.0;
+
+		// The GPU starts on a frame some time after it is submitted, so the submit is the earliest it can be placed.
+		if (Profiler::IsEnabled())
+			Profiler::GpuZone(scope.name, block.anchor, beginUs, endUs);
+
+		if (frame)
+		{
+			mLastFrame.push_back({ scope.name, scope.depth, beginUs / 1000.0, (endUs - beginUs) / 1000.0 });
+			mLastFrameMs = std::max(mLastFrameMs, endUs / 1000.0);
+		}
+
+		auto it = std::find_if(mTotals.begin(), mTotals.end(), [&scope](const ScopeTotal& total) { return total.name == scope.name; });
+		if (it == mTotals.end())
+			mTotals.push_back({ scope.name, 1, (endUs - beginUs) / 1000.0 });
+		else
+		{
+			it->count++;
+			it->totalMs += (endUs - beginUs) / 1000.0;
+		}
+	}
+
+	block.usedQueries = 0;
+}
+
+void GpuProfiler::DrawPanel()
+{
+	ImGui::Begin("GPU");
+
+	if (!IsSupported())
+		ImGui::Text("Timestamp queries are not supported");
+
+	for (const auto& scope : mLastFrame)
+		ImGui::Text("%*s%-24s %8.3f ms", scope.depth * 2, "", scope.name, scope.durationMs);
+
+	ImGui::Text("Late readbacks: %llu", static_cast<unsigned long long>(mLateFrames));
+
+	ImGui::End();
+}
+
+void GpuProfiler::PrintReport()
+{
+	for (const auto& total : mTotals)
+		std::cout << "GPU " << total.name << ": " << total.totalMs / total.count << " ms average over " << total.count << " scopes\n";
+
+	if (mLateFrames > 0)
+		std::cout << "GPU profiler skipped " << mLateFrames << " readbacks that were not ready\n";
+}
\ No newline at end of file
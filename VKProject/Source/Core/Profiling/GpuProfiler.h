@@ -0,0 +1,97 @@
+#pragma once
+
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <Core/Vulkan/VkHandle.h>
+
+#include <string>
+#include <vector>
+
+struct GpuScopeResult
+{
+	const char* name;
+	uint32_t depth;
+	double beginMs;
+	double durationMs;
+};
+
+// Timestamp queries around labeled GPU scopes. Every frame in flight owns a block of queries that is read back the
+// next time that frame is recorded, after its fence has signalled, so results never stall the CPU. One-off command
+// buffers use a separate block that is read after their queue wait. Results go to the CPU profiler's GPU track,
+// an ImGui panel and a per-scope report at exit. Scopes are recorded from the thread recording the primary buffers.
+class GpuProfiler
+{
+public:
+	static const uint32_t MaxScopes = 32;
+
+	GpuProfiler(const DeviceHandle& device) : mDevice(device) {}
+
+	void Init(VkPhysicalDevice physDevice, uint32_t queueFamily, uint32_t framesInFlight);
+
+	bool IsSupported() const { return mQueryPool != VK_NULL_HANDLE; }
+
+	// Reads back the results this frame slot produced last time, then resets its queries. Outside a render pass.
+	void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+	// Call right before the frame is submitted; places the frame on the CPU timeline.
+	void Submit();
+
+	// Same for one-off command buffers, which are waited on right after submission.
+	void BeginImmediate(VkCommandBuffer commandBuffer);
+	void EndImmediate();
+
+	void BeginScope(VkCommandBuffer commandBuffer, const char* name);
+	void EndScope(VkCommandBuffer commandBuffer);
+
+	const std::vector<GpuScopeResult>& GetLastFrame() const { return mLastFrame; }
+	// Frames read back so far and the span of the last one, for sampling GPU frame times once per readback.
+	uint64_t GetCollectedFrames() const { return mCollectedFrames; }
+	double GetLastFrameMs() const { return mLastFrameMs; }
+
+	void DrawPanel();
+	void PrintReport();
+private:
+	struct Scope
+	{
+		const char* name;
+		uint32_t depth;
+		uint32_t query;
+	};
+
+	struct Block
+	{
+		uint32_t firstQuery = 0;
+		uint32_t usedQueries = 0;
+		int64_t anchor = 0;
+		std::vector<Scope> scopes;
+		std::vector<uint32_t> open;
+	};
+
+	struct ScopeTotal
+	{
+		const char* name;
+		uint32_t count;
+		double totalMs;
+	};
+
+	void reset(VkCommandBuffer commandBuffer, Block& block);
+	void collect(Block& block, bool frame);
+
+	const DeviceHandle& mDevice;
+	VkHandle<VkQueryPool, vkDestroyQueryPool> mQueryPool;
+
+	double mTimestampPeriod = 1.0;
+	uint64_t mTimestampMask = ~0ull;
+
+	std::vector<Block> mBlocks;
+	Block* mCurrent = nullptr;
+	Block* mInterrupted = nullptr;
+
+	std::vector<GpuScopeResult> mLastFrame;
+	uint64_t mCollectedFrames = 0;
+	double mLastFrameMs = 0.0;
+	std::vector<ScopeTotal> mTotals;
+	uint64_t mLateFrames = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,355 @@
+#include "Profiler.h"
+
+#include <ImGui/imgui.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+std::atomic<bool> Profiler::sEnabled{ false };
+thread_local ZoneBuffer* Profiler::tBuffer = nullptr;
+thread_local std::string Profiler::tThreadName;
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::~Profiler()
+{
+	Stop();
+}
+
+ZoneBuffer* Profiler::registerThread()
+{
+	std::lock_guard<std::mutex> lock(mThreadsMutex);
+
+	auto state = std::make_unique<ThreadState>();
+	state->buffer = std::make_unique<ZoneBuffer>();
+	state->name = tThreadName.empty() ? "Thread " + std::to_string(mThreads.size()) : tThreadName;
+
+	tBuffer = state->buffer.get();
+	mThreads.push_back(std::move(state));
+
+	return tBuffer;
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	tThreadName = name;
+
+	if (!tBuffer)
+		return;
+
+	std::lock_guard<std::mutex> lock(mThreadsMutex);
+
+	for (auto& state : mThreads)
+	{
+		if (state->buffer.get() == tBuffer)
+		{
+			state->name = name;
+			state->named = false;
+		}
+	}
+}
+
+void Profiler::calibrate()
+{
+#ifdef PROFILER_USE_TSC
+	// The longer the session the better the estimate; the first collect is already a few milliseconds in.
+	int64_t ticks = Now() - mStartTicks;
+	double us = std::chrono::duration<double, std::micro>(Clock::now() - mStartTime).count();
+
+	if (ticks > 0 && us > 0.0)
+		mUsPerTick = us / ticks;
+#endif
+}
+
+void Profiler::Start(const std::string& fileName)
+{
+	std::lock_guard<std::mutex> lock(mCollectorMutex);
+
+	if (mRunning)
+		return;
+
+	// Throw away whatever was left in the buffers by a previous session.
+	{
+		std::lock_guard<std::mutex> threadsLock(mThreadsMutex);
+
+		for (auto& state : mThreads)
+		{
+			state->buffer->Drain([](const ZoneEvent&) {});
+			state->openZones.clear();
+			state->named = false;
+		}
+	}
+
+	mFileName = fileName;
+	mFirstEvent = true;
+	mGpuTrackNamed = false;
+	mStartTicks = Now();
+	mStartTime = Clock::now();
+	mUsPerTick = std::chrono::duration<double, std::micro>(Clock::duration(1)).count();
+	mWindowStats.clear();
+	mWindowStart = Clock::now();
+
+	if (!mFileName.empty())
+	{
+		mFile.open(mFileName);
+
+		if (!mFile.is_open())
+			throw std::runtime_error("Failed to open file! (" + mFileName + ")");
+
+		mFile << "{\n\t\"displayTimeUnit\": \"ms\",\n\t\"traceEvents\": [\n";
+		mFile << std::fixed << std::setprecision(3);
+	}
+
+	mRunning = true;
+	sEnabled = true;
+
+	mCollector = std::thread(&Profiler::collectorLoop, this);
+}
+
+void Profiler::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mCollectorMutex);
+
+		if (!mRunning)
+			return;
+
+		sEnabled = false;
+		mRunning = false;
+	}
+
+	mCollectorWake.notify_all();
+	mCollector.join();
+
+	collect();
+	publishStats();
+
+	if (mFile.is_open())
+	{
+		mFile << "\n\t]\n}\n";
+		mFile.close();
+
+		std::cout << "Profile trace written to " << mFileName << '\n';
+	}
+
+	uint64_t dropped = GetDroppedCount();
+	if (dropped > 0)
+		std::cout << "Profiler dropped " << dropped << " events, the collector could not keep up\n";
+}
+
+void Profiler::collectorLoop()
+{
+	std::unique_lock<std::mutex> lock(mCollectorMutex);
+
+	while (mRunning)
+	{
+		mCollectorWake.wait_for(lock, std::chrono::milliseconds(2));
+
+		lock.unlock();
+
+		collect();
+
+		if (Clock::now() - mWindowStart >= std::chrono::seconds(1))
+			publishStats();
+
+		lock.lock();
+	}
+}
+
+void Profiler::collect()
+{
+	calibrate();
+
+	// Threads are only ever added, so the snapshot stays valid while the lock is released.
+	std::vector<ThreadState*> threads;
+	{
+		std::lock_guard<std::mutex> lock(mThreadsMutex);
+
+		for (auto& state : mThreads)
+		{
+			if (!state->named && mFile.is_open())
+			{
+				if (!mFirstEvent)
+					mFile << ",\n";
+
+				mFile << "\t\t{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << threads.size()
+					<< ", \"args\": { \"name\": \"" << state->name << "\" } }";
+				mFirstEvent = false;
+			}
+
+			state->named = true;
+			threads.push_back(state.get());
+		}
+	}
+
+	for (uint32_t i = 0; i < threads.size(); i++)
+		threads[i]->buffer->Drain([this, i, &threads](const ZoneEvent& event) { consume(i, *threads[i], event); });
+}
+
+void Profiler::consume(uint32_t thread, ThreadState& state, const ZoneEvent& event)
+{
+	ZoneStats& stats = mWindowStats[event.name];
+
+	switch (event.type)
+	{
+	case ZoneEventType::Begin:
+		state.openZones.push_back(event);
+		break;
+	case ZoneEventType::End:
+	{
+		// Zones opened before Start have no begin event to pair with.
+		if (state.openZones.empty())
+			return;
+
+		double ms = (event.ticks - state.openZones.back().ticks) * mUsPerTick / 1000.0;
+		state.openZones.pop_back();
+
+		stats.count++;
+		stats.totalMs += ms;
+		stats.maxMs = std::max(stats.maxMs, ms);
+		break;
+	}
+	case ZoneEventType::Value:
+		stats.count++;
+		stats.lastValue = event.value;
+		stats.isValue = true;
+		break;
+	case ZoneEventType::GpuBegin:
+		state.openZones.push_back(event);
+		return;
+	case ZoneEventType::GpuEnd:
+	{
+		// Both halves of a GPU zone are pushed back to back, so the begin is always on top.
+		if (state.openZones.empty() || state.openZones.back().type != ZoneEventType::GpuBegin)
+			return;
+
+		double beginUs = state.openZones.back().value;
+		state.openZones.pop_back();
+
+		double ms = (event.value - beginUs) / 1000.0;
+		stats.count++;
+		stats.totalMs += ms;
+		stats.maxMs = std::max(stats.maxMs, ms);
+
+		writeGpuZone(event, beginUs);
+		return;
+	}
+	}
+
+	if (!mFile.is_open())
+		return;
+
+	if (!mFirstEvent)
+		mFile << ",\n";
+
+	mFirstEvent = false;
+
+	if (event.type == ZoneEventType::Value)
+	{
+		mFile << "\t\t{ \"name\": \"" << event.name << "\", \"ph\": \"C\", \"pid\": 1, \"tid\": " << thread
+			<< ", \"ts\": " << toUs(event.ticks) << ", \"args\": { \"value\": " << event.value << " } }";
+	}
+	else
+	{
+		mFile << "\t\t{ \"name\": \"" << event.name << "\", \"cat\": \"cpu\", \"ph\": \"" << (event.type == ZoneEventType::Begin ? "B" : "E")
+			<< "\", \"pid\": 1, \"tid\": " << thread << ", \"ts\": " << toUs(event.ticks) << " }";
+	}
+}
+
+void Profiler::writeGpuZone(const ZoneEvent& event, double beginUs)
+{
+	if (!mFile.is_open())
+		return;
+
+	if (!mFirstEvent)
+		mFile << ",\n";
+
+	mFirstEvent = false;
+
+	if (!mGpuTrackNamed)
+	{
+		mFile << "\t\t{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << GpuTrack << ", \"args\": { \"name\": \"GPU\" } },\n";
+		mGpuTrackNamed = true;
+	}
+
+	mFile << "\t\t{ \"name\": \"" << event.name << "\", \"cat\": \"gpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << GpuTrack
+		<< ", \"ts\": " << toUs(event.ticks) + beginUs << ", \"dur\": " << event.value - beginUs << " }";
+}
+
+void Profiler::publishStats()
+{
+	// The same literal can live at different addresses in different translation units.
+	std::vector<ZoneStats> stats;
+
+	for (auto& entry : mWindowStats)
+	{
+		auto it = std::find_if(stats.begin(), stats.end(), [&entry](const ZoneStats& s) { return s.name == entry.first; });
+
+		if (it == stats.end())
+		{
+			stats.push_back(entry.second);
+			stats.back().name = entry.first;
+			continue;
+		}
+
+		it->count += entry.second.count;
+		it->totalMs += entry.second.totalMs;
+		it->maxMs = std::max(it->maxMs, entry.second.maxMs);
+		it->lastValue = entry.second.lastValue;
+	}
+
+	std::sort(stats.begin(), stats.end(), [](const ZoneStats& a, const ZoneStats& b) { return a.totalMs > b.totalMs; });
+
+	mWindowStats.clear();
+	mWindowStart = Clock::now();
+
+	std::lock_guard<std::mutex> lock(mStatsMutex);
+	mStats = std::move(stats);
+}
+
+uint64_t Profiler::GetDroppedCount()
+{
+	std::lock_guard<std::mutex> lock(mThreadsMutex);
+
+	uint64_t dropped = 0;
+	for (auto& state : mThreads)
+		dropped += state->buffer->GetDropped();
+
+	return dropped;
+}
+
+std::vector<ZoneStats> Profiler::GetStats()
+{
+	std::lock_guard<std::mutex> lock(mStatsMutex);
+	return mStats;
+}
+
+void Profiler::DrawPanel()
+{
+	if (!IsEnabled())
+		return;
+
+	std::lock_guard<std::mutex> lock(mStatsMutex);
+
+	ImGui::Begin("Profiler");
+
+	ImGui::Text("Trace: %s", mFileName.empty() ? "live only" : mFileName.c_str());
+	ImGui::Text("Last second, sorted by total time");
+	ImGui::Separator();
+
+	for (const auto& stats : mStats)
+	{
+		if (stats.isValue)
+			ImGui::Text("%-28s value %10.3f", stats.name.c_str(), stats.lastValue);
+		else
+			ImGui::Text("%-28s %6u calls %9.3f ms total %8.3f ms max", stats.name.c_str(), stats.count, stats.totalMs, stats.maxMs);
+	}
+
+	ImGui::End();
+}
\ No newline at end of file
@@ -0,0 +1,235 @@
+#pragma once
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define PROFILER_USE_TSC
+#endif
+
+enum class ZoneEventType : uint32_t
+{
+	Begin,
+	End,
+	Value,
+	GpuBegin,
+	GpuEnd
+};
+
+struct ZoneEvent
+{
+	const char* name;
+	int64_t ticks;
+	double value;
+	ZoneEventType type;
+};
+
+// Single producer / single consumer ring owned by one thread. The owner pushes, the collector drains; when the
+// collector falls behind events are dropped instead of blocking the owner. Zones are dropped whole: an accepted begin
+// reserves the slot of its end, and an end is only pushed for an accepted begin.
+class ZoneBuffer
+{
+public:
+	static const uint32_t Capacity = 1 << 15;
+
+	bool Push(const ZoneEvent& event)
+	{
+		uint32_t head = mHead.load(std::memory_order_relaxed);
+		bool isBegin = event.type == ZoneEventType::Begin || event.type == ZoneEventType::GpuBegin;
+		bool isEnd = event.type == ZoneEventType::End || event.type == ZoneEventType::GpuEnd;
+
+		if (isEnd)
+		{
+			mReserved--;
+		}
+		else if (head - mTail.load(std::memory_order_acquire) + mReserved + (isBegin ? 2 : 1) > Capacity)
+		{
+			mDropped.store(mDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return false;
+		}
+		else if (isBegin)
+		{
+			mReserved++;
+		}
+
+		mEvents[head & (Capacity - 1)] = event;
+		mHead.store(head + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	template<typename F>
+	uint32_t Drain(F&& consume)
+	{
+		uint32_t tail = mTail.load(std::memory_order_relaxed);
+		uint32_t head = mHead.load(std::memory_order_acquire);
+
+		for (uint32_t i = tail; i != head; i++)
+			consume(mEvents[i & (Capacity - 1)]);
+
+		mTail.store(head, std::memory_order_release);
+
+		return head - tail;
+	}
+
+	uint64_t GetDropped() const { return mDropped.load(std::memory_order_relaxed); }
+private:
+	alignas(64) std::atomic<uint32_t> mHead{ 0 };
+	alignas(64) std::atomic<uint32_t> mTail{ 0 };
+	std::atomic<uint64_t> mDropped{ 0 };
+	// Ends still owed to accepted begins; only touched by the owner.
+	uint32_t mReserved = 0;
+	std::unique_ptr<ZoneEvent[]> mEvents{ new ZoneEvent[Capacity] };
+};
+
+struct ZoneStats
+{
+	std::string name;
+	uint32_t count = 0;
+	double totalMs = 0.0;
+	double maxMs = 0.0;
+	double lastValue = 0.0;
+	bool isValue = false;
+};
+
+// CPU zone profiler. Zones and values go into a lock-free buffer per thread; a collector thread drains them into a
+// Chrome trace and into per-second statistics for the ImGui panel. While stopped a zone costs a single relaxed load.
+// On x64 events are stamped with the TSC, which the collector calibrates against the steady clock.
+class Profiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static Profiler& Get();
+
+	// An empty file name keeps the live statistics only.
+	void Start(const std::string& fileName);
+	void Stop();
+
+	static bool IsEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+	// Returns false when the zone was dropped; EndZone must then not be called for it.
+	static bool BeginZone(const char* name) { return emit(ZoneEventType::Begin, name, 0.0); }
+	static void EndZone(const char* name) { emit(ZoneEventType::End, name, 0.0); }
+	static void Value(const char* name, double value) { emit(ZoneEventType::Value, name, value); }
+
+	// A GPU scope on its own track. Begin and end are microseconds after anchor, a timestamp taken with Now().
+	static void GpuZone(const char* name, int64_t anchor, double beginUs, double endUs)
+	{
+		ZoneBuffer* buffer = tBuffer ? tBuffer : Get().registerThread();
+		if (buffer->Push({ name, anchor, beginUs, ZoneEventType::GpuBegin }))
+			buffer->Push({ name, anchor, endUs, ZoneEventType::GpuEnd });
+	}
+
+	static int64_t Now()
+	{
+#ifdef PROFILER_USE_TSC
+		return static_cast<int64_t>(__rdtsc());
+#else
+		return Clock::now().time_since_epoch().count();
+#endif
+	}
+
+	// Names the calling thread in the trace. Does not allocate the thread's buffer.
+	void SetThreadName(const std::string& name);
+
+	uint64_t GetDroppedCount();
+	std::vector<ZoneStats> GetStats();
+
+	void DrawPanel();
+private:
+	struct ThreadState
+	{
+		std::unique_ptr<ZoneBuffer> buffer;
+		std::string name;
+		std::vector<ZoneEvent> openZones;
+		bool named = false;
+	};
+
+	Profiler() = default;
+	~Profiler();
+
+	static bool emit(ZoneEventType type, const char* name, double value)
+	{
+		ZoneBuffer* buffer = tBuffer ? tBuffer : Get().registerThread();
+		return buffer->Push({ name, Now(), value, type });
+	}
+
+	ZoneBuffer* registerThread();
+	void collectorLoop();
+	void collect();
+	void consume(uint32_t thread, ThreadState& state, const ZoneEvent& event);
+	void writeGpuZone(const ZoneEvent& event, double beginUs);
+	void publishStats();
+	void calibrate();
+
+	double toUs(int64_t ticks) const { return (ticks - mStartTicks) * mUsPerTick; }
+
+	static const uint32_t GpuTrack = 1000;
+
+	static std::atomic<bool> sEnabled;
+	static thread_local ZoneBuffer* tBuffer;
+	static thread_local std::string tThreadName;
+
+	std::mutex mThreadsMutex;
+	std::vector<std::unique_ptr<ThreadState>> mThreads;
+
+	std::thread mCollector;
+	std::mutex mCollectorMutex;
+	std::condition_variable mCollectorWake;
+	bool mRunning = false;
+
+	std::string mFileName;
+	std::ofstream mFile;
+	bool mFirstEvent = true;
+	bool mGpuTrackNamed = false;
+	int64_t mStartTicks = 0;
+	Clock::time_point mStartTime;
+	double mUsPerTick = 0.0;
+
+	// Owned by the collector; published once per second.
+	std::unordered_map<const char*, ZoneStats> mWindowStats;
+	Clock::time_point mWindowStart;
+
+	std::mutex mStatsMutex;
+	std::vector<ZoneStats> mStats;
+};
+
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name) : mName(Profiler::IsEnabled() && Profiler::BeginZone(name) ? name : nullptr)
+	{
+	}
+
+	~ProfileZone()
+	{
+		if (mName)
+			Profiler::EndZone(mName);
+	}
+private:
+	const char* mName;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_VALUE(name, value) do { if (Profiler::IsEnabled()) Profiler::Value(name, static_cast<double>(value)); } while (0)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#ifndef PROFILERBENCHMARK_H
+#define PROFILERBENCHMARK_H
+
+// Measures the cost of an empty profiling zone while stopped and while recording, on one and on all threads,
+// against the 50 ns per zone budget. Started with --bench-zones.
+namespace ProfilerBenchmark
+{
+	int Run();
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "StartupTrace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+StartupTrace& StartupTrace::Get()
+{
+	static StartupTrace trace;
+	return trace;
+}
+
+void StartupTrace::Enable(const std::string& fileName)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mFileName = fileName;
+	mStart = Clock::now();
+	mEvents.clear();
+	mEnabled = true;
+}
+
+uint32_t StartupTrace::threadIndex(std::thread::id id)
+{
+	auto it = std::find(mThreads.begin(), mThreads.end(), id);
+	if (it != mThreads.end())
+		return static_cast<uint32_t>(it - mThreads.begin());
+
+	mThreads.push_back(id);
+	return static_cast<uint32_t>(mThreads.size() - 1);
+}
+
+void StartupTrace::Record(const char* name, Clock::time_point begin, Clock::time_point end)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (!mEnabled)
+		return;
+
+	mEvents.push_back({ name, begin, end, threadIndex(std::this_thread::get_id()) });
+}
+
+void StartupTrace::Finish()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (!mEnabled)
+		return;
+
+	mEnabled = false;
+
+	std::sort(mEvents.begin(), mEvents.end(), [](const Event& a, const Event& b) { return a.begin < b.begin; });
+
+	auto toUs = [this](Clock::time_point time) { return std::chrono::duration<double, std::micro>(time - mStart).count(); };
+
+	std::ofstream file(mFileName);
+
+	if (file.is_open())
+	{
+		file << "{\n\t\"displayTimeUnit\": \"ms\",\n\t\"traceEvents\": [\n";
+
+		for (size_t i = 0; i < mEvents.size(); i++)
+		{
+			const Event& event = mEvents[i];
+
+			file << "\t\t{ \"name\": \"" << event.name << "\", \"cat\": \"startup\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+				<< ", \"ts\": " << std::fixed << std::setprecision(3) << toUs(event.begin)
+				<< ", \"dur\": " << toUs(event.end) - toUs(event.begin) << " }"
+				<< (i + 1 < mEvents.size() ? ",\n" : "\n");
+		}
+
+		file << "\t]\n}\n";
+
+		std::cout << "Startup trace written to " << mFileName << '\n';
+	}
+	else
+	{
+		std::cout << "Failed to write startup trace " << mFileName << '\n';
+	}
+
+	std::cout << std::left << std::setw(32) << "Stage" << std::right << std::setw(8) << "Thread" << std::setw(12) << "Start ms" << std::setw(12) << "Time ms" << '\n';
+
+	for (const Event& event : mEvents)
+	{
+		std::cout << std::left << std::setw(32) << event.name << std::right << std::setw(8) << event.thread
+			<< std::fixed << std::setprecision(2) << std::setw(12) << toUs(event.begin) / 1000.0
+			<< std::setw(12) << (toUs(event.end) - toUs(event.begin)) / 1000.0 << '\n';
+	}
+
+	std::cout << std::defaultfloat << std::setprecision(6);
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Core/Profiling/Profiler.h>
+
+// Records the duration of named startup stages and writes them as a Chrome trace (chrome://tracing, Perfetto)
+// plus a summary table on stdout. While disabled a TRACE_SCOPE costs a single relaxed load.
+class StartupTrace
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static StartupTrace& Get();
+
+	void Enable(const std::string& fileName);
+	bool IsEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+
+	void Record(const char* name, Clock::time_point begin, Clock::time_point end);
+
+	// Writes the trace and summary, then stops recording.
+	void Finish();
+private:
+	struct Event
+	{
+		const char* name;
+		Clock::time_point begin;
+		Clock::time_point end;
+		uint32_t thread;
+	};
+
+	StartupTrace() = default;
+
+	uint32_t threadIndex(std::thread::id id);
+
+	std::atomic<bool> mEnabled{ false };
+	std::string mFileName;
+	Clock::time_point mStart;
+
+	std::mutex mMutex;
+	std::vector<Event> mEvents;
+	std::vector<std::thread::id> mThreads;
+};
+
+// Startup stages also show up as zones when the profiler is running.
+class TraceScope
+{
+public:
+	explicit TraceScope(const char* name) : mName(name), mZone(name)
+	{
+		if (StartupTrace::Get().IsEnabled())
+			mBegin = StartupTrace::Clock::now();
+	}
+
+	~TraceScope()
+	{
+		if (mBegin != StartupTrace::Clock::time_point{})
+			StartupTrace::Get().Record(mName, mBegin, StartupTrace::Clock::now());
+	}
+private:
+	const char* mName;
+	StartupTrace::Clock::time_point mBegin{};
+	ProfileZone mZone;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+FramePacer::~FramePacer()
+{
+	SetFrameRateLimit(0);
+}
+
+void FramePacer::SetFrameRateLimit(uint32_t framesPerSecond)
+{
+	mFrameRateLimit = framesPerSecond;
+	mPeriod = framesPerSecond ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond)) : Clock::duration{};
+	mDeadline = Clock::now();
+
+#ifdef _WIN32
+	// The default 15.6 ms scheduler tick makes every sleep useless for pacing.
+	bool raise = framesPerSecond > 0;
+	if (raise != mTimerPeriodRaised)
+	{
+		if (raise)
+			timeBeginPeriod(1);
+		else
+			timeEndPeriod(1);
+
+		mTimerPeriodRaised = raise;
+	}
+#endif
+}
+
+void FramePacer::Wait()
+{
+	if (mFrameRateLimit == 0)
+	{
+		mLastWaitMs = 0.0;
+		return;
+	}
+
+	Clock::time_point start = Clock::now();
+
+	// A frame that ran long re-bases the schedule at now, so the next one waits a full period instead of rushing to catch up.
+	mDeadline = std::max(mDeadline + mPeriod, start);
+
+	if (mDeadline - start > mSpinMargin)
+	{
+		Clock::time_point wake = mDeadline - mSpinMargin;
+		std::this_thread::sleep_until(wake);
+
+		// Grow the margin right away when a sleep overshoots, shrink it slowly otherwise.
+		Clock::duration late = Clock::now() - wake;
+		if (late > Clock::duration::zero())
+			mSpinMargin = std::max(mSpinMargin - mSpinMargin / 64, late + late / 4);
+		else
+			mSpinMargin -= mSpinMargin / 64;
+
+		mSpinMargin = std::clamp<Clock::duration>(mSpinMargin, std::chrono::microseconds(200), std::chrono::milliseconds(4));
+	}
+
+	while (Clock::now() < mDeadline)
+		std::this_thread::yield();
+
+	mLastWaitMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void FramePacer::AddLatency(double ms)
+{
+	mLatencySamples.push_back(ms);
+
+	mLatencyHistogram[std::min<size_t>(static_cast<size_t>(std::max(ms, 0.0) * 10.0), LatencyBuckets - 1)]++;
+	mLatencyCount++;
+	mLatencySum += ms;
+	mLatencyMax = std::max(mLatencyMax, ms);
+
+	Clock::time_point now = Clock::now();
+	if (now - mLatencyWindowStart >= std::chrono::seconds(1))
+	{
+		mLatencyWindow = summarize(std::move(mLatencySamples));
+		mLatencySamples.clear();
+		mLatencyWindowStart = now;
+	}
+}
+
+LatencyStats FramePacer::GetTotalLatency() const
+{
+	LatencyStats stats;
+
+	if (mLatencyCount == 0)
+		return stats;
+
+	stats.count = static_cast<uint32_t>(mLatencyCount);
+	stats.meanMs = mLatencySum / mLatencyCount;
+	stats.maxMs = mLatencyMax;
+
+	uint64_t rank = mLatencyCount - mLatencyCount / 100;
+	uint64_t seen = 0;
+
+	for (uint32_t i = 0; i < LatencyBuckets; i++)
+	{
+		seen += mLatencyHistogram[i];
+
+		if (seen >= rank)
+		{
+			stats.p99Ms = std::min((i + 1) / 10.0, mLatencyMax);
+			break;
+		}
+	}
+
+	return stats;
+}
+
+LatencyStats FramePacer::summarize(std::vector<double> samples)
+{
+	LatencyStats stats;
+
+	if (samples.empty())
+		return stats;
+
+	std::sort(samples.begin(), samples.end());
+
+	stats.count = static_cast<uint32_t>(samples.size());
+	stats.meanMs = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+	stats.p99Ms = samples[std::min(samples.size() - 1, static_cast<size_t>(samples.size() * 0.99))];
+	stats.maxMs = samples.back();
+
+	return stats;
+}
\ No newline at end of file
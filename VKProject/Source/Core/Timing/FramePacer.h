@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+struct LatencyStats
+{
+	uint32_t count = 0;
+	double meanMs = 0.0;
+	double p99Ms = 0.0;
+	double maxMs = 0.0;
+};
+
+// Caps the frame rate and keeps input-to-present latency figures. The limiter sleeps for most of the remaining time
+// and spins the rest; the spin margin follows how late the sleeps actually wake up, so it stays as short as the OS
+// timer allows. Wait() belongs right before input is polled, so a capped frame does not sit on stale input.
+class FramePacer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	~FramePacer();
+
+	// Zero turns the cap off.
+	void SetFrameRateLimit(uint32_t framesPerSecond);
+	uint32_t GetFrameRateLimit() const { return mFrameRateLimit; }
+
+	void Wait();
+
+	// Time spent sleeping and spinning in the last Wait().
+	double GetLastWaitMs() const { return mLastWaitMs; }
+
+	void AddLatency(double ms);
+	// Over the last second, for the overlay; the totals cover the whole run.
+	LatencyStats GetLatency() const { return mLatencyWindow; }
+	LatencyStats GetTotalLatency() const;
+private:
+	static LatencyStats summarize(std::vector<double> samples);
+
+	uint32_t mFrameRateLimit = 0;
+	Clock::duration mPeriod{};
+	Clock::time_point mDeadline{};
+	Clock::duration mSpinMargin = std::chrono::microseconds(1500);
+	double mLastWaitMs = 0.0;
+	bool mTimerPeriodRaised = false;
+
+	std::vector<double> mLatencySamples;
+
+	// Whole-run totals stay bounded for long kiosk sessions: 0.1 ms buckets up to half a second.
+	static const uint32_t LatencyBuckets = 5000;
+	std::vector<uint32_t> mLatencyHistogram = std::vector<uint32_t>(LatencyBuckets);
+	uint64_t mLatencyCount = 0;
+	double mLatencySum = 0.0;
+	double mLatencyMax = 0.0;
+	Clock::time_point mLatencyWindowStart = Clock::now();
+	LatencyStats mLatencyWindow;
+};
+
+#endif
\ No newline at end of file
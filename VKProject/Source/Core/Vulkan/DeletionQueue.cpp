@@ -0,0 +1,40 @@
+#include "DeletionQueue.h"
+
+#include <algorithm>
+
+void DeletionQueue::push(const Entry& entry)
+{
+	mEntries.push_back(entry);
+
+	mRetired++;
+	mPeakPending = std::max(mPeakPending, mEntries.size());
+}
+
+void DeletionQueue::Flush(uint64_t completedValue)
+{
+	// Entries are pushed in value order, so everything that is due sits at the front.
+	auto due = std::find_if(mEntries.begin(), mEntries.end(), [completedValue](const Entry& entry) { return entry.value > completedValue; });
+
+	if (due == mEntries.begin())
+		return;
+
+	for (auto it = mEntries.begin(); it != due; ++it)
+		it->destroy(it->device, it->handle);
+
+	mLastBatch = static_cast<size_t>(due - mEntries.begin());
+	mDestroyed += mLastBatch;
+
+	mEntries.erase(mEntries.begin(), due);
+}
+
+DeletionStats DeletionQueue::GetStats() const
+{
+	DeletionStats stats;
+	stats.pending = mEntries.size();
+	stats.peakPending = mPeakPending;
+	stats.retired = mRetired;
+	stats.destroyed = mDestroyed;
+	stats.lastBatch = mLastBatch;
+
+	return stats;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef DELETIONQUEUE_H
+#define DELETIONQUEUE_H
+
+#include <vulkan/vulkan.h>
+
+#include <Core/Vulkan/HostAllocator.h>
+
+#include <cstdint>
+#include <deque>
+
+struct DeletionStats
+{
+	size_t pending = 0;
+	size_t peakPending = 0;
+	uint64_t retired = 0;
+	uint64_t destroyed = 0;
+	// Destroyed by the last Flush that had anything due.
+	size_t lastBatch = 0;
+};
+
+// Defers destruction of GPU objects that submitted work may still reference. Entries are tagged with the last value
+// signalled on the queue's timeline when they were retired and destroyed in one batch once the queue has completed
+// that value. An entry is the handle, its device and a plain function pointer, so retiring never allocates past the
+// queue's own storage.
+class DeletionQueue
+{
+public:
+	~DeletionQueue() { Flush(UINT64_MAX); }
+
+	template <auto Destroy, class T>
+	void Push(uint64_t value, VkDevice device, T handle)
+	{
+		push({ value, device, (uint64_t)handle, &destroy<T, Destroy> });
+	}
+
+	void Flush(uint64_t completedValue);
+
+	size_t GetPendingCount() const { return mEntries.size(); }
+	DeletionStats GetStats() const;
+private:
+	struct Entry
+	{
+		uint64_t value;
+		VkDevice device;
+		uint64_t handle;
+		void (*destroy)(VkDevice device, uint64_t handle);
+	};
+
+	template <class T, auto Destroy>
+	static void destroy(VkDevice device, uint64_t handle)
+	{
+		Destroy(device, (T)handle, HostAllocator::Get().Callbacks());
+	}
+
+	void push(const Entry& entry);
+
+	std::deque<Entry> mEntries;
+
+	size_t mPeakPending = 0;
+	uint64_t mRetired = 0;
+	uint64_t mDestroyed = 0;
+	size_t mLastBatch = 0;
+};
+
+#endif
\ No newline at end of file
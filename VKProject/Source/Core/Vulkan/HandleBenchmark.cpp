@@ -0,0 +1,145 @@
+#include "HandleBenchmark.h"
+
+#include <Core/Vulkan/VkHandle.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+	const uint32_t HandlesPerRound = 1 << 18;
+	const uint32_t VectorSize = 1024;
+	const uint32_t RoundCount = 16;
+
+	uint64_t sDestroyed = 0;
+
+	void destroyBuffer(VkDevice, VkBuffer, const VkAllocationCallbacks*)
+	{
+		sDestroyed++;
+	}
+
+	// The wrapper as it was: a std::function around a lambda holding a reference to the device wrapper and a second
+	// std::function. Copyable, which vectors of it relied on.
+	template <class T>
+	class LegacyDeleter
+	{
+	public:
+		LegacyDeleter() : LegacyDeleter([](T, const VkAllocationCallbacks*) {}) {}
+		LegacyDeleter(std::function<void(T, const VkAllocationCallbacks*)> deletef) { deleter = [=](T obj) { deletef(obj, HostAllocator::Get().Callbacks()); }; }
+		LegacyDeleter(const LegacyDeleter<VkDevice>& device, std::function<void(VkDevice, T, const VkAllocationCallbacks*)> deletef) { deleter = [&device, deletef](T obj) { deletef(device, obj, HostAllocator::Get().Callbacks()); }; }
+		~LegacyDeleter() { cleanup(); }
+
+		operator T() const { return object; }
+
+		T* replace()
+		{
+			cleanup();
+			return &object;
+		}
+	private:
+		T object{ VK_NULL_HANDLE };
+		std::function<void(T)> deleter;
+
+		void cleanup()
+		{
+			if (object != VK_NULL_HANDLE)
+				deleter(object);
+			object = VK_NULL_HANDLE;
+		}
+	};
+
+	VkBuffer fakeBuffer(uint32_t i)
+	{
+		return (VkBuffer)(uintptr_t)(i + 1);
+	}
+
+	// Best round in nanoseconds per handle.
+	template <class F>
+	double measure(uint32_t handlesPerCall, F churn)
+	{
+		double best = 1e9;
+
+		for (uint32_t round = 0; round < RoundCount; round++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+
+			for (uint32_t i = 0; i < HandlesPerRound; i += handlesPerCall)
+				churn(i);
+
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count() / HandlesPerRound;
+			best = std::min(best, ns);
+		}
+
+		return best;
+	}
+
+	void report(const char* label, double legacyNs, double handleNs)
+	{
+		std::cout << label << ": legacy " << legacyNs << " ns/handle, VkHandle " << handleNs << " ns/handle (" << legacyNs / handleNs << "x)\n";
+	}
+}
+
+int HandleBenchmark::Run()
+{
+	LegacyDeleter<VkDevice> legacyDevice{ [](VkDevice, const VkAllocationCallbacks*) {} };
+	VkDevice device = (VkDevice)(uintptr_t)1;
+
+	// What the legacy lambda captured: the device reference and the inner std::function. Heap allocated whenever it
+	// does not fit the std::function's inline buffer, which depends on the standard library.
+	size_t legacyCapture = sizeof(void*) + sizeof(std::function<void(VkDevice, VkBuffer, const VkAllocationCallbacks*)>);
+
+	std::cout << "Handle benchmark: " << RoundCount << " rounds of " << HandlesPerRound << " handles\n";
+	std::cout << "Footprint: legacy " << sizeof(LegacyDeleter<VkBuffer>) << " bytes + " << legacyCapture << " bytes captured, VkHandle "
+		<< sizeof(VkHandle<VkBuffer, destroyBuffer>) << " bytes, " << sizeof(DeviceHandle) << " without a parent\n";
+
+	uint64_t expected = 0;
+
+	double legacySingle = measure(1, [&legacyDevice](uint32_t i)
+	{
+		LegacyDeleter<VkBuffer> buffer{ legacyDevice, destroyBuffer };
+		*buffer.replace() = fakeBuffer(i);
+	});
+
+	double handleSingle = measure(1, [device](uint32_t i)
+	{
+		VkHandle<VkBuffer, destroyBuffer> buffer;
+		*buffer.replace(device) = fakeBuffer(i);
+	});
+
+	expected += 2ull * RoundCount * HandlesPerRound;
+
+	double legacyVector = measure(VectorSize, [&legacyDevice](uint32_t first)
+	{
+		std::vector<LegacyDeleter<VkBuffer>> buffers;
+		buffers.resize(VectorSize, LegacyDeleter<VkBuffer>{ legacyDevice, destroyBuffer });
+
+		for (uint32_t i = 0; i < VectorSize; i++)
+			*buffers[i].replace() = fakeBuffer(first + i);
+	});
+
+	double handleVector = measure(VectorSize, [device](uint32_t first)
+	{
+		std::vector<VkHandle<VkBuffer, destroyBuffer>> buffers;
+		buffers.resize(VectorSize);
+
+		for (uint32_t i = 0; i < VectorSize; i++)
+			*buffers[i].replace(device) = fakeBuffer(first + i);
+	});
+
+	expected += 2ull * RoundCount * HandlesPerRound;
+
+	report("Single handles", legacySingle, handleSingle);
+	report(("Vectors of " + std::to_string(VectorSize)).c_str(), legacyVector, handleVector);
+
+	if (sDestroyed != expected)
+	{
+		std::cout << "Destroyed " << sDestroyed << " handles, expected " << expected << '\n';
+		return 1;
+	}
+
+	return handleSingle <= legacySingle && handleVector <= legacyVector ? 0 : 1;
+}
\ No newline at end of file
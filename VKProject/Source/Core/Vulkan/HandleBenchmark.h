@@ -0,0 +1,14 @@
+#pragma once
+
+#ifndef HANDLEBENCHMARK_H
+#define HANDLEBENCHMARK_H
+
+// Compares VkHandle with the std::function based deleter it replaced: bytes per handle, and the cost of creating
+// and destroying handles one at a time and as a vector like swap chain recreation does. Destroy functions are stubs,
+// so only the wrapper is measured. Started with --bench-handles.
+namespace HandleBenchmark
+{
+	int Run();
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "HostAllocator.h"
+
+#include <ImGui/imgui.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	// Every block handed to the driver is preceded by this header so that frees and reallocations,
+	// which do not carry a scope or size, can be attributed correctly.
+	struct BlockHeader
+	{
+		uint64_t size;
+		uint32_t offset;
+		uint8_t scope;
+		uint8_t sizeClass;
+		uint16_t padding;
+	};
+
+	static_assert(sizeof(BlockHeader) == 16, "BlockHeader must keep 16 byte alignment");
+
+	const uint8_t NotPooled = 0xFF;
+	const size_t PoolAlignment = sizeof(BlockHeader);
+	const size_t PoolChunkSize = 64 * 1024;
+	const size_t SizeClasses[] = { 32, 64, 128, 256, 512, 1024 };
+
+	const char* scopeNames[] = { "Command", "Object", "Cache", "Device", "Instance" };
+
+	BlockHeader* headerOf(void* memory)
+	{
+		return reinterpret_cast<BlockHeader*>(static_cast<char*>(memory) - sizeof(BlockHeader));
+	}
+
+	void addStats(HostAllocationStats& dst, const HostAllocationStats& src)
+	{
+		dst.allocations += src.allocations;
+		dst.reallocations += src.reallocations;
+		dst.frees += src.frees;
+		dst.internalAllocations += src.internalAllocations;
+		dst.bytesAllocated += src.bytesAllocated;
+		dst.liveBytes += src.liveBytes;
+		dst.peakBytes += src.peakBytes;
+	}
+}
+
+HostAllocator& HostAllocator::Get()
+{
+	static HostAllocator allocator;
+	return allocator;
+}
+
+HostAllocator::HostAllocator()
+{
+	mCallbacks.pUserData = this;
+	mCallbacks.pfnAllocation = allocationCallback;
+	mCallbacks.pfnReallocation = reallocationCallback;
+	mCallbacks.pfnFree = freeCallback;
+	mCallbacks.pfnInternalAllocation = internalAllocationCallback;
+	mCallbacks.pfnInternalFree = internalFreeCallback;
+
+	for (size_t i = 0; i < mPools.size(); i++)
+		mPools[i].blockSize = SizeClasses[i] + sizeof(BlockHeader);
+}
+
+void HostAllocator::SetMode(HostAllocatorMode mode)
+{
+	mMode = mode;
+}
+
+void* HostAllocator::poolAllocate(uint32_t sizeClass)
+{
+	Pool& pool = mPools[sizeClass];
+	std::lock_guard<std::mutex> lock(pool.mutex);
+
+	if (!pool.freeList)
+	{
+		char* chunk = static_cast<char*>(std::malloc(PoolChunkSize));
+		if (!chunk)
+			return nullptr;
+
+		pool.chunks.push_back(chunk);
+
+		for (size_t offset = 0; offset + pool.blockSize <= PoolChunkSize; offset += pool.blockSize)
+		{
+			void* block = chunk + offset;
+			*static_cast<void**>(block) = pool.freeList;
+			pool.freeList = block;
+		}
+	}
+
+	void* block = pool.freeList;
+	pool.freeList = *static_cast<void**>(block);
+
+	return block;
+}
+
+void HostAllocator::poolFree(uint32_t sizeClass, void* block)
+{
+	Pool& pool = mPools[sizeClass];
+	std::lock_guard<std::mutex> lock(pool.mutex);
+
+	*static_cast<void**>(block) = pool.freeList;
+	pool.freeList = block;
+}
+
+void* HostAllocator::allocate(size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	if (size == 0)
+		return nullptr;
+
+	uint8_t sizeClass = NotPooled;
+
+	if (mMode == HostAllocatorMode::Pooled && alignment <= PoolAlignment)
+	{
+		for (uint8_t i = 0; i < mPools.size(); i++)
+		{
+			if (size <= SizeClasses[i])
+			{
+				sizeClass = i;
+				break;
+			}
+		}
+	}
+
+	char* raw = nullptr;
+	char* memory = nullptr;
+
+	if (sizeClass != NotPooled)
+	{
+		raw = static_cast<char*>(poolAllocate(sizeClass));
+		if (!raw)
+			return nullptr;
+
+		memory = raw + sizeof(BlockHeader);
+	}
+	else
+	{
+		alignment = std::max(alignment, PoolAlignment);
+
+		raw = static_cast<char*>(std::malloc(size + alignment + sizeof(BlockHeader)));
+		if (!raw)
+			return nullptr;
+
+		uintptr_t address = reinterpret_cast<uintptr_t>(raw) + sizeof(BlockHeader);
+		address = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+		memory = reinterpret_cast<char*>(address);
+	}
+
+	BlockHeader* header = headerOf(memory);
+	header->size = size;
+	header->offset = static_cast<uint32_t>(memory - raw);
+	header->scope = static_cast<uint8_t>(scope);
+	header->sizeClass = sizeClass;
+
+	Counters& counters = mCounters[scope];
+	counters.allocations++;
+	counters.bytesAllocated += size;
+
+	int64_t live = counters.liveBytes += static_cast<int64_t>(size);
+	int64_t peak = counters.peakBytes;
+	while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live)) {}
+
+	return memory;
+}
+
+void* HostAllocator::reallocate(void* original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	if (!original)
+		return allocate(size, alignment, scope);
+
+	if (size == 0)
+	{
+		free(original);
+		return nullptr;
+	}
+
+	mCounters[scope].reallocations++;
+
+	void* memory = allocate(size, alignment, scope);
+	if (!memory)
+		return nullptr;
+
+	std::memcpy(memory, original, std::min<size_t>(size, headerOf(original)->size));
+	free(original);
+
+	return memory;
+}
+
+void HostAllocator::free(void* memory)
+{
+	if (!memory)
+		return;
+
+	BlockHeader* header = headerOf(memory);
+
+	Counters& counters = mCounters[header->scope];
+	counters.frees++;
+	counters.liveBytes -= static_cast<int64_t>(header->size);
+
+	char* raw = static_cast<char*>(memory) - header->offset;
+
+	if (header->sizeClass != NotPooled)
+		poolFree(header->sizeClass, raw);
+	else
+		std::free(raw);
+}
+
+VKAPI_ATTR void* VKAPI_CALL HostAllocator::allocationCallback(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	return static_cast<HostAllocator*>(userData)->allocate(size, alignment, scope);
+}
+
+VKAPI_ATTR void* VKAPI_CALL HostAllocator::reallocationCallback(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	return static_cast<HostAllocator*>(userData)->reallocate(original, size, alignment, scope);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::freeCallback(void* userData, void* memory)
+{
+	static_cast<HostAllocator*>(userData)->free(memory);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::internalAllocationCallback(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope)
+{
+	Counters& counters = static_cast<HostAllocator*>(userData)->mCounters[scope];
+	counters.internalAllocations++;
+	counters.bytesAllocated += size;
+	counters.liveBytes += static_cast<int64_t>(size);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::internalFreeCallback(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope)
+{
+	Counters& counters = static_cast<HostAllocator*>(userData)->mCounters[scope];
+	counters.frees++;
+	counters.liveBytes -= static_cast<int64_t>(size);
+}
+
+HostAllocationStats HostAllocator::GetStats(VkSystemAllocationScope scope) const
+{
+	const Counters& counters = mCounters[scope];
+
+	HostAllocationStats stats;
+	stats.allocations = counters.allocations;
+	stats.reallocations = counters.reallocations;
+	stats.frees = counters.frees;
+	stats.internalAllocations = counters.internalAllocations;
+	stats.bytesAllocated = counters.bytesAllocated;
+	stats.liveBytes = counters.liveBytes;
+	stats.peakBytes = counters.peakBytes;
+
+	return stats;
+}
+
+HostAllocationStats HostAllocator::GetTotalStats() const
+{
+	HostAllocationStats total;
+
+	for (uint32_t i = 0; i < ScopeCount; i++)
+		addStats(total, GetStats(static_cast<VkSystemAllocationScope>(i)));
+
+	return total;
+}
+
+void HostAllocator::BeginFrame()
+{
+	HostAllocationStats current = GetTotalStats();
+
+	mLastFrame.allocations = current.allocations - mFrameStart.allocations;
+	mLastFrame.reallocations = current.reallocations - mFrameStart.reallocations;
+	mLastFrame.frees = current.frees - mFrameStart.frees;
+	mLastFrame.internalAllocations = current.internalAllocations - mFrameStart.internalAllocations;
+	mLastFrame.bytesAllocated = current.bytesAllocated - mFrameStart.bytesAllocated;
+	mLastFrame.liveBytes = current.liveBytes - mFrameStart.liveBytes;
+	mLastFrame.peakBytes = current.peakBytes;
+
+	mFrameStart = current;
+}
+
+void HostAllocator::DrawPanel()
+{
+	if (mMode == HostAllocatorMode::Disabled)
+		return;
+
+	ImGui::Begin("Host allocations");
+
+	ImGui::Text("Mode: %s", mMode == HostAllocatorMode::Pooled ? "pooled" : "tracking");
+	ImGui::Text("Last frame: %llu allocs, %llu reallocs, %llu frees, %llu bytes",
+		static_cast<unsigned long long>(mLastFrame.allocations), static_cast<unsigned long long>(mLastFrame.reallocations),
+		static_cast<unsigned long long>(mLastFrame.frees), static_cast<unsigned long long>(mLastFrame.bytesAllocated));
+
+	ImGui::Separator();
+
+	for (uint32_t i = 0; i < ScopeCount; i++)
+	{
+		HostAllocationStats stats = GetStats(static_cast<VkSystemAllocationScope>(i));
+
+		ImGui::Text("%-8s %8llu allocs %8llu frees %10.1f Kb live %10.1f Kb peak", scopeNames[i],
+			static_cast<unsigned long long>(stats.allocations + stats.internalAllocations), static_cast<unsigned long long>(stats.frees),
+			stats.liveBytes / 1024.0f, stats.peakBytes / 1024.0f);
+	}
+
+	ImGui::End();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#ifndef HOSTALLOCATOR_H
+#define HOSTALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+struct HostAllocationStats
+{
+	uint64_t allocations = 0;
+	uint64_t reallocations = 0;
+	uint64_t frees = 0;
+	uint64_t internalAllocations = 0;
+	uint64_t bytesAllocated = 0;
+	int64_t liveBytes = 0;
+	int64_t peakBytes = 0;
+};
+
+enum class HostAllocatorMode
+{
+	Disabled,
+	Tracking,
+	Pooled
+};
+
+// VkAllocationCallbacks implementation that counts driver host allocations per VkSystemAllocationScope
+// and can serve small blocks from size class pools instead of the C runtime heap.
+class HostAllocator
+{
+public:
+	static const uint32_t ScopeCount = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+	static HostAllocator& Get();
+
+	// Must be called before any Vulkan object is created; objects have to be destroyed with the callbacks they were created with.
+	void SetMode(HostAllocatorMode mode);
+	HostAllocatorMode GetMode() const { return mMode; }
+
+	const VkAllocationCallbacks* Callbacks() const { return mMode == HostAllocatorMode::Disabled ? nullptr : &mCallbacks; }
+
+	HostAllocationStats GetStats(VkSystemAllocationScope scope) const;
+	HostAllocationStats GetTotalStats() const;
+
+	// Call once per frame; the difference to the previous call is reported as the last frame's churn.
+	void BeginFrame();
+	const HostAllocationStats& GetLastFrameStats() const { return mLastFrame; }
+
+	void DrawPanel();
+private:
+	HostAllocator();
+
+	struct Counters
+	{
+		std::atomic<uint64_t> allocations{ 0 };
+		std::atomic<uint64_t> reallocations{ 0 };
+		std::atomic<uint64_t> frees{ 0 };
+		std::atomic<uint64_t> internalAllocations{ 0 };
+		std::atomic<uint64_t> bytesAllocated{ 0 };
+		std::atomic<int64_t> liveBytes{ 0 };
+		std::atomic<int64_t> peakBytes{ 0 };
+	};
+
+	struct Pool
+	{
+		std::mutex mutex;
+		size_t blockSize = 0;
+		void* freeList = nullptr;
+		std::vector<void*> chunks;
+	};
+
+	void* allocate(size_t size, size_t alignment, VkSystemAllocationScope scope);
+	void* reallocate(void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+	void free(void* memory);
+
+	void* poolAllocate(uint32_t sizeClass);
+	void poolFree(uint32_t sizeClass, void* block);
+
+	static VKAPI_ATTR void* VKAPI_CALL allocationCallback(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope);
+	static VKAPI_ATTR void* VKAPI_CALL reallocationCallback(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+	static VKAPI_ATTR void VKAPI_CALL freeCallback(void* userData, void* memory);
+	static VKAPI_ATTR void VKAPI_CALL internalAllocationCallback(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+	static VKAPI_ATTR void VKAPI_CALL internalFreeCallback(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+
+	VkAllocationCallbacks mCallbacks{};
+	HostAllocatorMode mMode = HostAllocatorMode::Disabled;
+
+	std::array<Counters, ScopeCount> mCounters;
+	std::array<Pool, 6> mPools;
+
+	HostAllocationStats mFrameStart;
+	HostAllocationStats mLastFrame;
+};
+
+#endif
@@ -0,0 +1,323 @@
+#include "MemoryTracker.h"
+
+#include <ImGui/imgui.h>
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+static const char* allocationKindName(AllocationKind kind)
+{
+	switch (kind)
+	{
+	case AllocationKind::Buffer:
+		return "buffer";
+	case AllocationKind::Image:
+		return "image";
+	default:
+		return "memory";
+	}
+}
+
+static float toMb(VkDeviceSize bytes)
+{
+	return static_cast<float>(bytes) / (1024.0f * 1024.0f);
+}
+
+MemoryTracker& MemoryTracker::Get()
+{
+	static MemoryTracker tracker;
+	return tracker;
+}
+
+void MemoryTracker::Init(VkInstance instance, VkPhysicalDevice physDevice, bool budgetSupported)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mPhysDevice = physDevice;
+	vkGetPhysicalDeviceMemoryProperties(mPhysDevice, &mMemProperties);
+
+	mGetMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+	mBudgetSupported = budgetSupported && mGetMemoryProperties2 != nullptr;
+
+	for (uint32_t i = 0; i < mMemProperties.memoryHeapCount; i++)
+	{
+		mHeapBudget[i] = mMemProperties.memoryHeaps[i].size;
+		mHeapUsage[i] = 0;
+	}
+}
+
+void MemoryTracker::UpdateBudget()
+{
+	if (!mBudgetSupported)
+		return;
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+	VkPhysicalDeviceMemoryProperties2 memProps2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2 };
+	memProps2.pNext = &budgetProps;
+
+	mGetMemoryProperties2(mPhysDevice, &memProps2);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (uint32_t i = 0; i < mMemProperties.memoryHeapCount; i++)
+	{
+		mHeapBudget[i] = budgetProps.heapBudget[i];
+		mHeapUsage[i] = budgetProps.heapUsage[i];
+	}
+}
+
+VkDeviceSize MemoryTracker::headroom(uint32_t heap)
+{
+	VkDeviceSize used = mBudgetSupported ? mHeapUsage[heap] : mHeapTracked[heap];
+
+	return mHeapBudget[heap] > used ? mHeapBudget[heap] - used : 0;
+}
+
+uint32_t MemoryTracker::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags props, VkDeviceSize size)
+{
+	UpdateBudget();
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	uint32_t bestType = UINT32_MAX;
+	VkDeviceSize bestHeadroom = 0;
+
+	for (uint32_t i = 0; i < mMemProperties.memoryTypeCount; i++)
+	{
+		if (!(typeFilter & (1 << i)) || (mMemProperties.memoryTypes[i].propertyFlags & props) != props)
+			continue;
+
+		VkDeviceSize room = headroom(mMemProperties.memoryTypes[i].heapIndex);
+
+		if (bestType == UINT32_MAX || (bestHeadroom < size && room > bestHeadroom))
+		{
+			bestType = i;
+			bestHeadroom = room;
+		}
+	}
+
+	if (bestType == UINT32_MAX)
+		throw std::runtime_error("Failed to find suitable memory type!");
+
+	return bestType;
+}
+
+bool MemoryTracker::HasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags props)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (uint32_t i = 0; i < mMemProperties.memoryTypeCount; i++)
+		if ((typeFilter & (1 << i)) && (mMemProperties.memoryTypes[i].propertyFlags & props) == props)
+			return true;
+
+	return false;
+}
+
+void MemoryTracker::track(uint64_t handle, AllocationKind kind, const std::string& tag, VkDeviceSize size, uint32_t memoryType)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	AllocationRecord record;
+	record.tag = tag;
+	record.kind = kind;
+	record.size = size;
+	record.memoryType = memoryType;
+	record.heap = mMemProperties.memoryTypes[memoryType].heapIndex;
+
+	if (kind == AllocationKind::Memory)
+		mHeapTracked[record.heap] += size;
+
+	mAllocations[handle] = record;
+}
+
+void MemoryTracker::TrackBuffer(VkBuffer buffer, const std::string& tag, VkDeviceSize size, uint32_t memoryType)
+{
+	track(MemoryTrackerKey(buffer), AllocationKind::Buffer, tag, size, memoryType);
+}
+
+void MemoryTracker::TrackImage(VkImage image, const std::string& tag, VkDeviceSize size, uint32_t memoryType)
+{
+	track(MemoryTrackerKey(image), AllocationKind::Image, tag, size, memoryType);
+}
+
+void MemoryTracker::TrackMemory(VkDeviceMemory memory, const std::string& tag, VkDeviceSize size, uint32_t memoryType)
+{
+	track(MemoryTrackerKey(memory), AllocationKind::Memory, tag, size, memoryType);
+}
+
+void MemoryTracker::Untrack(uint64_t handle)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = mAllocations.find(handle);
+	if (it == mAllocations.end())
+		return;
+
+	if (it->second.kind == AllocationKind::Memory)
+		mHeapTracked[it->second.heap] -= it->second.size;
+
+	mAllocations.erase(it);
+}
+
+std::vector<HeapStats> MemoryTracker::GetHeapStats()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::vector<HeapStats> stats(mMemProperties.memoryHeapCount);
+
+	for (uint32_t i = 0; i < mMemProperties.memoryHeapCount; i++)
+	{
+		stats[i].size = mMemProperties.memoryHeaps[i].size;
+		stats[i].budget = mHeapBudget[i];
+		stats[i].usage = mBudgetSupported ? mHeapUsage[i] : mHeapTracked[i];
+		stats[i].trackedBytes = mHeapTracked[i];
+		stats[i].deviceLocal = mMemProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+	}
+
+	for (const auto& allocation : mAllocations)
+	{
+		if (allocation.second.kind == AllocationKind::Memory)
+			stats[allocation.second.heap].allocationCount++;
+	}
+
+	return stats;
+}
+
+std::vector<AllocationRecord> MemoryTracker::GetAllocations()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::vector<AllocationRecord> allocations;
+	allocations.reserve(mAllocations.size());
+
+	for (const auto& allocation : mAllocations)
+		allocations.push_back(allocation.second);
+
+	std::sort(allocations.begin(), allocations.end(), [](const AllocationRecord& a, const AllocationRecord& b) { return a.size > b.size; });
+
+	return allocations;
+}
+
+VkDeviceSize MemoryTracker::GetTotalAllocated()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	VkDeviceSize total = 0;
+	for (uint32_t i = 0; i < mMemProperties.memoryHeapCount; i++)
+		total += mHeapTracked[i];
+
+	return total;
+}
+
+void MemoryTracker::DrawPanel(std::pmr::memory_resource* arena)
+{
+	UpdateBudget();
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::pmr::vector<const AllocationRecord*> allocations(arena);
+	allocations.reserve(mAllocations.size());
+
+	std::pmr::vector<uint32_t> heapAllocations(mMemProperties.memoryHeapCount, 0, arena);
+	VkDeviceSize total = 0;
+
+	for (const auto& allocation : mAllocations)
+	{
+		allocations.push_back(&allocation.second);
+
+		if (allocation.second.kind == AllocationKind::Memory)
+		{
+			heapAllocations[allocation.second.heap]++;
+			total += allocation.second.size;
+		}
+	}
+
+	std::sort(allocations.begin(), allocations.end(), [](const AllocationRecord* a, const AllocationRecord* b) { return a->size > b->size; });
+
+	ImGui::Begin("Memory");
+
+	ImGui::Text("Tracked: %.2f Mb in %zu allocations", toMb(total), allocations.size());
+	ImGui::Text("VK_EXT_memory_budget: %s", mBudgetSupported ? "yes" : "no");
+
+	for (uint32_t i = 0; i < mMemProperties.memoryHeapCount; i++)
+	{
+		VkDeviceSize usage = mBudgetSupported ? mHeapUsage[i] : mHeapTracked[i];
+
+		ImGui::Separator();
+		ImGui::Text("Heap %u (%s)", i, mMemProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ? "device local" : "host");
+		ImGui::Text("Usage: %.2f / %.2f Mb", toMb(usage), toMb(mHeapBudget[i]));
+		ImGui::ProgressBar(mHeapBudget[i] ? static_cast<float>(usage) / static_cast<float>(mHeapBudget[i]) : 0.0f);
+		ImGui::Text("Tracked: %.2f Mb (%u allocations)", toMb(mHeapTracked[i]), heapAllocations[i]);
+	}
+
+	if (ImGui::CollapsingHeader("Allocations"))
+	{
+		for (const auto* allocation : allocations)
+			ImGui::Text("%-8s %-24s %8.2f Mb type %u heap %u", allocationKindName(allocation->kind), allocation->tag.c_str(), toMb(allocation->size), allocation->memoryType, allocation->heap);
+	}
+
+	ImGui::End();
+}
+
+void MemoryTracker::WriteJson(const std::string& fileName)
+{
+	auto heaps = GetHeapStats();
+	auto allocations = GetAllocations();
+
+	std::ofstream file(fileName);
+
+	if (!file.is_open())
+		throw std::runtime_error("Failed to open file! (" + fileName + ")");
+
+	file << "{\n";
+	file << "\t\"budgetSupported\": " << (mBudgetSupported ? "true" : "false") << ",\n";
+	file << "\t\"totalAllocated\": " << GetTotalAllocated() << ",\n";
+	file << "\t\"heaps\": [\n";
+
+	for (size_t i = 0; i < heaps.size(); i++)
+	{
+		file << "\t\t{ \"index\": " << i
+			<< ", \"deviceLocal\": " << (heaps[i].deviceLocal ? "true" : "false")
+			<< ", \"size\": " << heaps[i].size
+			<< ", \"budget\": " << heaps[i].budget
+			<< ", \"usage\": " << heaps[i].usage
+			<< ", \"tracked\": " << heaps[i].trackedBytes
+			<< ", \"allocations\": " << heaps[i].allocationCount << " }"
+			<< (i + 1 < heaps.size() ? ",\n" : "\n");
+	}
+
+	file << "\t],\n";
+	file << "\t\"allocations\": [\n";
+
+	for (size_t i = 0; i < allocations.size(); i++)
+	{
+		file << "\t\t{ \"tag\": \"" << allocations[i].tag << "\""
+			<< ", \"kind\": \"" << allocationKindName(allocations[i].kind) << "\""
+			<< ", \"size\": " << allocations[i].size
+			<< ", \"memoryType\": " << allocations[i].memoryType
+			<< ", \"heap\": " << allocations[i].heap << " }"
+			<< (i + 1 < allocations.size() ? ",\n" : "\n");
+	}
+
+	file << "\t]\n";
+	file << "}\n";
+}
+
+void DestroyTrackedBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator)
+{
+	MemoryTracker::Get().Untrack(MemoryTrackerKey(buffer));
+	vkDestroyBuffer(device, buffer, pAllocator);
+}
+
+void DestroyTrackedImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
+{
+	MemoryTracker::Get().Untrack(MemoryTrackerKey(image));
+	vkDestroyImage(device, image, pAllocator);
+}
+
+void FreeTrackedMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator)
+{
+	MemoryTracker::Get().Untrack(MemoryTrackerKey(memory));
+	vkFreeMemory(device, memory, pAllocator);
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#ifndef MEMORYTRACKER_H
+#define MEMORYTRACKER_H
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class AllocationKind
+{
+	Buffer,
+	Image,
+	Memory
+};
+
+struct AllocationRecord
+{
+	std::string tag;
+	AllocationKind kind = AllocationKind::Memory;
+	VkDeviceSize size = 0;
+	uint32_t memoryType = 0;
+	uint32_t heap = 0;
+};
+
+struct HeapStats
+{
+	VkDeviceSize size = 0;
+	VkDeviceSize budget = 0;
+	VkDeviceSize usage = 0;
+	VkDeviceSize trackedBytes = 0;
+	uint32_t allocationCount = 0;
+	bool deviceLocal = false;
+};
+
+// Records every buffer, image and device memory allocation made by the application
+// and, when VK_EXT_memory_budget is enabled, the driver reported budget per heap.
+class MemoryTracker
+{
+public:
+	static MemoryTracker& Get();
+
+	void Init(VkInstance instance, VkPhysicalDevice physDevice, bool budgetSupported);
+
+	// Picks the first memory type matching typeFilter/props, moving on to types whose heap has more budget headroom when size does not fit.
+	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags props, VkDeviceSize size);
+	bool HasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags props);
+
+	void TrackBuffer(VkBuffer buffer, const std::string& tag, VkDeviceSize size, uint32_t memoryType);
+	void TrackImage(VkImage image, const std::string& tag, VkDeviceSize size, uint32_t memoryType);
+	void TrackMemory(VkDeviceMemory memory, const std::string& tag, VkDeviceSize size, uint32_t memoryType);
+	void Untrack(uint64_t handle);
+
+	void UpdateBudget();
+
+	std::vector<HeapStats> GetHeapStats();
+	std::vector<AllocationRecord> GetAllocations();
+	VkDeviceSize GetTotalAllocated();
+
+	bool IsBudgetSupported() const { return mBudgetSupported; }
+
+	// Per-frame temporaries are taken from arena.
+	void DrawPanel(std::pmr::memory_resource* arena);
+	void WriteJson(const std::string& fileName);
+private:
+	MemoryTracker() = default;
+
+	void track(uint64_t handle, AllocationKind kind, const std::string& tag, VkDeviceSize size, uint32_t memoryType);
+	VkDeviceSize headroom(uint32_t heap);
+
+	std::mutex mMutex;
+
+	VkPhysicalDevice mPhysDevice = VK_NULL_HANDLE;
+	VkPhysicalDeviceMemoryProperties mMemProperties{};
+	PFN_vkGetPhysicalDeviceMemoryProperties2KHR mGetMemoryProperties2 = nullptr;
+	bool mBudgetSupported = false;
+
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> mHeapBudget{};
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> mHeapUsage{};
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> mHeapTracked{};
+
+	std::unordered_map<uint64_t, AllocationRecord> mAllocations;
+};
+
+template <class T>
+uint64_t MemoryTrackerKey(T handle) { return (uint64_t)handle; }
+
+void DestroyTrackedBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator);
+void DestroyTrackedImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator);
+void FreeTrackedMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator);
+
+#endif
\ No newline at end of file
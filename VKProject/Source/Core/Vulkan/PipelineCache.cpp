@@ -0,0 +1,93 @@
+#include "PipelineCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+void PipelineCache::Load(VkPhysicalDevice physDevice, const std::string& fileName)
+{
+	vkGetPhysicalDeviceProperties(physDevice, &mProperties);
+	mFileName = fileName;
+
+	std::vector<char> data;
+	std::ifstream file(fileName, std::ios::ate | std::ios::binary);
+
+	if (file.is_open())
+	{
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(data.data(), data.size());
+	}
+
+	mWarm = !data.empty() && isCompatible(data);
+
+	if (!data.empty() && !mWarm)
+		std::cout << "Pipeline cache " << fileName << " was written by another device or driver, starting with an empty cache\n";
+
+	VkPipelineCacheCreateInfo cacheInfo{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	cacheInfo.initialDataSize = mWarm ? data.size() : 0;
+	cacheInfo.pInitialData = mWarm ? data.data() : nullptr;
+
+	if (vkCreatePipelineCache(mDevice, &cacheInfo, HostAllocator::Get().Callbacks(), mCache.replace(mDevice)) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create pipeline cache!");
+}
+
+bool PipelineCache::isCompatible(const std::vector<char>& data) const
+{
+	// Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE: header size, header version, vendor ID, device ID and the cache UUID.
+	const size_t headerSize = 16 + VK_UUID_SIZE;
+
+	if (data.size() < headerSize)
+		return false;
+
+	uint32_t header[4];
+	std::memcpy(header, data.data(), sizeof(header));
+
+	return header[0] >= headerSize &&
+		header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		header[2] == mProperties.vendorID &&
+		header[3] == mProperties.deviceID &&
+		std::memcmp(data.data() + 16, mProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCache::Save()
+{
+	if (mCache == VK_NULL_HANDLE)
+		return;
+
+	size_t size = 0;
+	if (vkGetPipelineCacheData(mDevice, mCache, &size, nullptr) != VK_SUCCESS || size == 0)
+		return;
+
+	std::vector<char> data(size);
+	if (vkGetPipelineCacheData(mDevice, mCache, &size, data.data()) != VK_SUCCESS)
+		return;
+
+	// Written next to the old cache and moved over it, so a crash while writing never leaves a torn file behind.
+	std::string tempName = mFileName + ".tmp";
+
+	{
+		std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), size);
+		file.close();
+
+		if (file.fail())
+		{
+			std::cout << "Failed to write pipeline cache " << tempName << '\n';
+			return;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempName, mFileName, error);
+
+	if (error)
+	{
+		std::cout << "Failed to replace pipeline cache " << mFileName << ": " << error.message() << '\n';
+		std::filesystem::remove(tempName, error);
+		return;
+	}
+
+	std::cout << "Pipeline cache saved: " << size << " bytes\n";
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef PIPELINECACHE_H
+#define PIPELINECACHE_H
+
+#include <Core/Vulkan/VkHandle.h>
+
+#include <string>
+#include <vector>
+
+// VkPipelineCache that persists across runs. The file on disk is only used when its header matches the
+// vendor, device and pipelineCacheUUID of the current driver; otherwise the cache starts out empty.
+class PipelineCache
+{
+public:
+	PipelineCache(const DeviceHandle& device) : mDevice(device) {}
+
+	void Load(VkPhysicalDevice physDevice, const std::string& fileName);
+	void Save();
+
+	operator VkPipelineCache() const { return mCache; }
+
+	// True when the cache was seeded from a valid file.
+	bool IsWarm() const { return mWarm; }
+private:
+	bool isCompatible(const std::vector<char>& data) const;
+
+	const DeviceHandle& mDevice;
+	VkHandle<VkPipelineCache, vkDestroyPipelineCache> mCache;
+
+	VkPhysicalDeviceProperties mProperties{};
+	std::string mFileName;
+	bool mWarm = false;
+};
+
+#endif
\ No newline at end of file
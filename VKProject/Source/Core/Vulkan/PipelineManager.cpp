@@ -0,0 +1,115 @@
+#include "PipelineManager.h"
+
+#include <iostream>
+
+PipelineManager::~PipelineManager()
+{
+	Reset([this](VkPipeline pipeline) { vkDestroyPipeline(mDevice, pipeline, HostAllocator::Get().Callbacks()); });
+}
+
+PipelineHandle PipelineManager::Request(const std::string& name, std::function<VkPipeline()> compile)
+{
+	Entry* entry = nullptr;
+	PipelineHandle handle = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (mEntries.empty())
+			mFirstRequest = std::chrono::steady_clock::now();
+
+		handle = static_cast<PipelineHandle>(mEntries.size());
+		mEntries.emplace_back();
+		entry = &mEntries.back();
+		entry->name = name;
+	}
+
+	mJobs.Run([this, entry, compile]
+	{
+		auto start = std::chrono::steady_clock::now();
+		VkPipeline pipeline = compile();
+		auto end = std::chrono::steady_clock::now();
+
+		entry->compileTime = std::chrono::duration<double, std::milli>(end - start).count();
+		entry->pipeline.store(pipeline, std::memory_order_release);
+
+		if (pipeline != VK_NULL_HANDLE)
+		{
+			mReadyCount.fetch_add(1, std::memory_order_acq_rel);
+		}
+		else
+		{
+			mFailedCount.fetch_add(1, std::memory_order_acq_rel);
+			std::cout << "Pipeline " << entry->name << " failed to compile after " << entry->compileTime << " ms, draws keep using the fallback\n";
+		}
+
+		// Either this or Seal sees the last compile finish after the total is known; both use sequentially consistent
+		// accesses so they cannot both miss it.
+		uint32_t finished = mFinishedCount.fetch_add(1) + 1;
+		if (finished == mSealedCount.load())
+			reportFinished();
+	}, &mPending, JobAffinity::Background);
+
+	return handle;
+}
+
+void PipelineManager::Seal()
+{
+	uint32_t count = GetCount();
+	mSealedCount.store(count);
+
+	if (count > 0 && mFinishedCount.load() == count)
+		reportFinished();
+}
+
+void PipelineManager::reportFinished()
+{
+	if (mReported.exchange(true, std::memory_order_acq_rel))
+		return;
+
+	uint32_t count = mSealedCount.load(std::memory_order_relaxed);
+	uint32_t failed = GetFailedCount();
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mFirstRequest).count();
+
+	if (failed == 0)
+		std::cout << "All " << count << " pipelines ready " << ms << " ms after the first request\n";
+	else
+		std::cout << GetReadyCount() << " / " << count << " pipelines ready " << ms << " ms after the first request, " << failed << " failed\n";
+}
+
+VkPipeline PipelineManager::Get(PipelineHandle handle) const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (handle >= mEntries.size())
+		return VK_NULL_HANDLE;
+
+	return mEntries[handle].pipeline.load(std::memory_order_acquire);
+}
+
+uint32_t PipelineManager::GetCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return static_cast<uint32_t>(mEntries.size());
+}
+
+void PipelineManager::Reset(const std::function<void(VkPipeline)>& retire)
+{
+	mJobs.Wait(mPending);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (auto& entry : mEntries)
+	{
+		VkPipeline pipeline = entry.pipeline.load(std::memory_order_acquire);
+		if (pipeline != VK_NULL_HANDLE)
+			retire(pipeline);
+	}
+
+	mEntries.clear();
+	mReadyCount = 0;
+	mFailedCount = 0;
+	mFinishedCount = 0;
+	mSealedCount = 0;
+	mReported = false;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#ifndef PIPELINEMANAGER_H
+#define PIPELINEMANAGER_H
+
+#include <Core/Vulkan/VkHandle.h>
+#include <Core/Jobs/JobSystem.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+using PipelineHandle = uint32_t;
+
+// Compiles pipelines as background jobs. Get() returns VK_NULL_HANDLE until a pipeline is ready, so draws can be
+// skipped or use a fallback pipeline instead of waiting. Compile functions run concurrently and should share one
+// VkPipelineCache, which the driver synchronizes internally.
+class PipelineManager
+{
+public:
+	PipelineManager(const DeviceHandle& device, JobSystem& jobs) : mDevice(device), mJobs(jobs) {}
+	~PipelineManager();
+
+	PipelineHandle Request(const std::string& name, std::function<VkPipeline()> compile);
+	// Called after the last Request of a batch. Compiles can finish while requests are still coming in, so only once
+	// the total is known can the batch's completion be reported, exactly once.
+	void Seal();
+
+	VkPipeline Get(PipelineHandle handle) const;
+	bool IsReady(PipelineHandle handle) const { return Get(handle) != VK_NULL_HANDLE; }
+
+	uint32_t GetCount() const;
+	uint32_t GetReadyCount() const { return mReadyCount.load(std::memory_order_acquire); }
+	// Compiles that returned VK_NULL_HANDLE. Their handles keep returning VK_NULL_HANDLE, so draws stay on the fallback.
+	uint32_t GetFailedCount() const { return mFailedCount.load(std::memory_order_acquire); }
+
+	// Waits for outstanding compiles, passes every pipeline to retire and forgets all handles.
+	void Reset(const std::function<void(VkPipeline)>& retire);
+private:
+	void reportFinished();
+
+	struct Entry
+	{
+		std::string name;
+		std::atomic<VkPipeline> pipeline{ VK_NULL_HANDLE };
+		double compileTime = 0.0;
+	};
+
+	const DeviceHandle& mDevice;
+	JobSystem& mJobs;
+
+	// A deque keeps entries in place while compile jobs hold pointers to them.
+	std::deque<Entry> mEntries;
+	mutable std::mutex mMutex;
+
+	JobCounter mPending;
+	std::atomic<uint32_t> mReadyCount{ 0 };
+	std::atomic<uint32_t> mFailedCount{ 0 };
+	std::atomic<uint32_t> mFinishedCount{ 0 };
+	// Zero until sealed.
+	std::atomic<uint32_t> mSealedCount{ 0 };
+	std::atomic<bool> mReported{ false };
+	std::chrono::steady_clock::time_point mFirstRequest;
+};
+
+#endif
\ No newline at end of file
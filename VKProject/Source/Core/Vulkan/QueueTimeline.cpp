@@ -0,0 +1,153 @@
+#include "QueueTimeline.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+QueueTimeline::~QueueTimeline()
+{
+	for (auto& pending : mPendingFences)
+		mFreeFences.push_back(pending.fence);
+
+	for (VkFence fence : mFreeFences)
+		vkDestroyFence(mDevice, fence, HostAllocator::Get().Callbacks());
+}
+
+bool QueueTimeline::IsSupported(VkInstance instance, VkPhysicalDevice physDevice)
+{
+	auto getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR");
+
+	if (!getFeatures2)
+		return false;
+
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR };
+	VkPhysicalDeviceFeatures2KHR features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR };
+	features.pNext = &timelineFeatures;
+
+	getFeatures2(physDevice, &features);
+
+	return timelineFeatures.timelineSemaphore == VK_TRUE;
+}
+
+void QueueTimeline::Init(bool timelineSemaphores)
+{
+	if (!timelineSemaphores)
+		return;
+
+	mGetCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(mDevice, "vkGetSemaphoreCounterValueKHR");
+	mWaitSemaphores = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(mDevice, "vkWaitSemaphoresKHR");
+
+	if (!mGetCounterValue || !mWaitSemaphores)
+		throw std::runtime_error("Failed to load VK_KHR_timeline_semaphore functions!");
+
+	VkSemaphoreTypeCreateInfoKHR typeInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR };
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+	semaphoreInfo.pNext = &typeInfo;
+
+	if (vkCreateSemaphore(mDevice, &semaphoreInfo, HostAllocator::Get().Callbacks(), mSemaphore.replace(mDevice)) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create timeline semaphore!");
+}
+
+VkFence QueueTimeline::acquireFence()
+{
+	if (!mFreeFences.empty())
+	{
+		VkFence fence = mFreeFences.back();
+		mFreeFences.pop_back();
+		vkResetFences(mDevice, 1, &fence);
+		return fence;
+	}
+
+	VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+
+	VkFence fence;
+	if (vkCreateFence(mDevice, &fenceInfo, HostAllocator::Get().Callbacks(), &fence) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create fences!");
+
+	return fence;
+}
+
+void QueueTimeline::Signal(VkSubmitInfo& submitInfo, TimelineSubmit& submit)
+{
+	submit.value = ++mLastSignalled;
+
+	if (!UsesTimeline())
+	{
+		submit.fence = acquireFence();
+		mPendingFences.push_back({ submit.value, submit.fence });
+		return;
+	}
+
+	if (submitInfo.waitSemaphoreCount > TimelineSubmit::MaxSemaphores || submitInfo.signalSemaphoreCount >= TimelineSubmit::MaxSemaphores)
+		throw std::runtime_error("Submission has too many semaphores for a timeline signal!");
+
+	// Values of binary semaphores are ignored, they only have to be there to line the arrays up.
+	std::copy_n(submitInfo.pSignalSemaphores, submitInfo.signalSemaphoreCount, submit.signalSemaphores);
+	submit.signalSemaphores[submitInfo.signalSemaphoreCount] = mSemaphore;
+	submit.signalValues[submitInfo.signalSemaphoreCount] = submit.value;
+
+	submit.timelineInfo.pNext = submitInfo.pNext;
+	submit.timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+	submit.timelineInfo.pWaitSemaphoreValues = submit.waitValues;
+	submit.timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount + 1;
+	submit.timelineInfo.pSignalSemaphoreValues = submit.signalValues;
+
+	submitInfo.pNext = &submit.timelineInfo;
+	submitInfo.signalSemaphoreCount++;
+	submitInfo.pSignalSemaphores = submit.signalSemaphores;
+}
+
+uint64_t QueueTimeline::GetCompleted()
+{
+	if (UsesTimeline())
+	{
+		uint64_t value = 0;
+		if (mGetCounterValue(mDevice, mSemaphore, &value) == VK_SUCCESS)
+			mCompleted = std::max(mCompleted, value);
+
+		return mCompleted;
+	}
+
+	while (!mPendingFences.empty() && vkGetFenceStatus(mDevice, mPendingFences.front().fence) == VK_SUCCESS)
+	{
+		mCompleted = std::max(mCompleted, mPendingFences.front().value);
+		mFreeFences.push_back(mPendingFences.front().fence);
+		mPendingFences.pop_front();
+	}
+
+	return mCompleted;
+}
+
+void QueueTimeline::Wait(uint64_t value)
+{
+	if (value <= mCompleted)
+		return;
+
+	if (value > mLastSignalled)
+		throw std::runtime_error("Waiting for a timeline value that was never signalled!");
+
+	if (UsesTimeline())
+	{
+		VkSemaphore semaphore = mSemaphore;
+
+		VkSemaphoreWaitInfoKHR waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR };
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &semaphore;
+		waitInfo.pValues = &value;
+
+		mWaitSemaphores(mDevice, &waitInfo, std::numeric_limits<uint64_t>::max());
+		GetCompleted();
+		return;
+	}
+
+	// Values are handed out in order, so the first fence at or past the value is the one for it.
+	auto it = std::find_if(mPendingFences.begin(), mPendingFences.end(), [value](const PendingFence& pending) { return pending.value >= value; });
+	vkWaitForFences(mDevice, 1, &it->fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+
+	// A fence covers everything submitted before it, though older fences are only recycled once they read signalled.
+	mCompleted = std::max(mCompleted, it->value);
+	GetCompleted();
+}
\ No newline at end of file
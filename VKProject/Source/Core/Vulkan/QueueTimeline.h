@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef QUEUETIMELINE_H
+#define QUEUETIMELINE_H
+
+#include <Core/Vulkan/VkHandle.h>
+
+#include <deque>
+#include <vector>
+
+// The arrays a submission points at once its timeline signal is added. Has to live until the submit call.
+struct TimelineSubmit
+{
+	static const uint32_t MaxSemaphores = 4;
+
+	VkTimelineSemaphoreSubmitInfoKHR timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR };
+	VkSemaphore signalSemaphores[MaxSemaphores] = {};
+	uint64_t waitValues[MaxSemaphores] = {};
+	uint64_t signalValues[MaxSemaphores] = {};
+
+	// Goes to vkQueueSubmit. Only set on the fence fallback.
+	VkFence fence = VK_NULL_HANDLE;
+	uint64_t value = 0;
+};
+
+// Completion tracking for one queue. Every submission that is waited on, frames and one-off uploads alike, signals
+// the next value of a timeline semaphore, and deferred deletion is keyed by the same values. Waiting for a value waits
+// for exactly that submission rather than a whole frame slot or the queue. Without VK_KHR_timeline_semaphore each
+// value gets a fence from a pool instead; submissions to one queue complete in order, so that is equivalent.
+// Used from one thread at a time.
+class QueueTimeline
+{
+public:
+	QueueTimeline(const DeviceHandle& device) : mDevice(device) {}
+	~QueueTimeline();
+
+	// Needs VK_KHR_get_physical_device_properties2 on the instance and the extension on the device.
+	static bool IsSupported(VkInstance instance, VkPhysicalDevice physDevice);
+
+	void Init(bool timelineSemaphores);
+
+	bool UsesTimeline() const { return mSemaphore != VK_NULL_HANDLE; }
+
+	// Reserves the next value and adds its signal to the submission, pointing submitInfo into submit.
+	void Signal(VkSubmitInfo& submitInfo, TimelineSubmit& submit);
+
+	// Highest value the GPU has finished. Polls without blocking.
+	uint64_t GetCompleted();
+	uint64_t GetLastSignalled() const { return mLastSignalled; }
+	bool IsComplete(uint64_t value) { return value <= mCompleted || value <= GetCompleted(); }
+
+	void Wait(uint64_t value);
+private:
+	struct PendingFence
+	{
+		uint64_t value;
+		VkFence fence;
+	};
+
+	VkFence acquireFence();
+
+	const DeviceHandle& mDevice;
+	VkHandle<VkSemaphore, vkDestroySemaphore> mSemaphore;
+
+	PFN_vkGetSemaphoreCounterValueKHR mGetCounterValue = nullptr;
+	PFN_vkWaitSemaphoresKHR mWaitSemaphores = nullptr;
+
+	uint64_t mLastSignalled = 0;
+	uint64_t mCompleted = 0;
+
+	std::deque<PendingFence> mPendingFences;
+	std::vector<VkFence> mFreeFences;
+};
+
+#endif
\ No newline at end of file
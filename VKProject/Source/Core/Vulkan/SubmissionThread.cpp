@@ -0,0 +1,289 @@
+#include "SubmissionThread.h"
+
+#include <Core/Profiling/Profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+SubmissionThread::~SubmissionThread()
+{
+	Stop();
+}
+
+void SubmissionThread::Start(VkDevice device, VkQueue graphicsQueue, VkQueue presentQueue)
+{
+	if (IsRunning())
+		return;
+
+	mDevice = device;
+	mGraphicsQueue = graphicsQueue;
+	mPresentQueue = presentQueue;
+	mTotal = SubmissionStats{};
+
+	mRunning = true;
+	mThread = std::thread(&SubmissionThread::threadLoop, this);
+}
+
+void SubmissionThread::Stop()
+{
+	if (!IsRunning())
+		return;
+
+	Flush();
+
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mRunning = false;
+	}
+
+	mWake.notify_all();
+	mThread.join();
+}
+
+void SubmissionThread::CheckSubmitError()
+{
+	int32_t error = mSubmitError.exchange(VK_SUCCESS, std::memory_order_acquire);
+	if (error != VK_SUCCESS)
+		throw std::runtime_error(std::string("failed to submit ") + mSubmitErrorName.load(std::memory_order_relaxed) + "!");
+}
+
+void SubmissionThread::push(const QueuePacket& packet)
+{
+	uint32_t head = mHead.load(std::memory_order_relaxed);
+
+	// Full only when the driver is far behind; the producer then has to wait like it would have on the call itself.
+	if (head - mTail.load(std::memory_order_acquire) == Capacity)
+	{
+		PROFILE_ZONE("Submission queue full");
+
+		auto start = std::chrono::steady_clock::now();
+
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		mSpace.wait(lock, [this, head] { return head - mTail.load(std::memory_order_acquire) < Capacity; });
+
+		mBlockedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	mPackets[head % Capacity] = packet;
+	mHead.store(head + 1, std::memory_order_release);
+
+	// Taking the lock orders the notify after the thread's predicate check, so the wake up cannot be lost.
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+	}
+	mWake.notify_one();
+}
+
+void SubmissionThread::wait(QueueCompletion& completion)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	{
+		std::unique_lock<std::mutex> lock(mCompletionMutex);
+		mCompleted.wait(lock, [&completion] { return completion.done; });
+	}
+
+	mBlockedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SubmissionThread::Submit(const VkSubmitInfo& submitInfo, VkFence fence, const char* name)
+{
+	CheckSubmitError();
+
+	if (submitInfo.waitSemaphoreCount > QueuePacket::MaxSemaphores || submitInfo.signalSemaphoreCount > QueuePacket::MaxSemaphores ||
+		submitInfo.commandBufferCount > QueuePacket::MaxCommandBuffers)
+	{
+		throw std::runtime_error("Submission does not fit into a queue packet!");
+	}
+
+	QueuePacket packet;
+	packet.type = QueuePacketType::Submit;
+	packet.waitSemaphoreCount = submitInfo.waitSemaphoreCount;
+	std::copy_n(submitInfo.pWaitSemaphores, submitInfo.waitSemaphoreCount, packet.waitSemaphores);
+	std::copy_n(submitInfo.pWaitDstStageMask, submitInfo.waitSemaphoreCount, packet.waitStages);
+	packet.commandBufferCount = submitInfo.commandBufferCount;
+	std::copy_n(submitInfo.pCommandBuffers, submitInfo.commandBufferCount, packet.commandBuffers);
+	packet.signalSemaphoreCount = submitInfo.signalSemaphoreCount;
+	std::copy_n(submitInfo.pSignalSemaphores, submitInfo.signalSemaphoreCount, packet.signalSemaphores);
+	packet.fence = fence;
+	packet.name = name;
+
+	// The only extension struct submissions carry here.
+	for (auto next = static_cast<const VkBaseInStructure*>(submitInfo.pNext); next; next = next->pNext)
+	{
+		if (next->sType != VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR)
+			continue;
+
+		auto timelineInfo = reinterpret_cast<const VkTimelineSemaphoreSubmitInfoKHR*>(next);
+		packet.timeline = true;
+		std::copy_n(timelineInfo->pWaitSemaphoreValues, timelineInfo->waitSemaphoreValueCount, packet.waitValues);
+		std::copy_n(timelineInfo->pSignalSemaphoreValues, timelineInfo->signalSemaphoreValueCount, packet.signalValues);
+	}
+
+	push(packet);
+}
+
+void SubmissionThread::Present(VkSwapchainKHR swapChain, uint32_t imageIndex, VkSemaphore waitSemaphore)
+{
+	CheckSubmitError();
+
+	QueuePacket packet;
+	packet.type = QueuePacketType::Present;
+	packet.swapChain = swapChain;
+	packet.imageIndex = imageIndex;
+	packet.waitSemaphoreCount = 1;
+	packet.waitSemaphores[0] = waitSemaphore;
+
+	push(packet);
+}
+
+VkResult SubmissionThread::AcquireNextImage(VkSwapchainKHR swapChain, VkSemaphore semaphore, uint32_t& imageIndex)
+{
+	std::lock_guard<std::mutex> lock(mSwapChainMutex);
+	return vkAcquireNextImageKHR(mDevice, swapChain, std::numeric_limits<uint64_t>::max(), semaphore, VK_NULL_HANDLE, &imageIndex);
+}
+
+void SubmissionThread::Flush()
+{
+	if (!IsRunning())
+		return;
+
+	QueueCompletion completion;
+
+	QueuePacket packet;
+	packet.type = QueuePacketType::Flush;
+	packet.completion = &completion;
+
+	push(packet);
+	wait(completion);
+}
+
+SubmissionStats SubmissionThread::TakeFrameStats()
+{
+	SubmissionStats stats;
+	stats.submitMs = mSubmitNs.exchange(0, std::memory_order_relaxed) / 1e6;
+	stats.presentMs = mPresentNs.exchange(0, std::memory_order_relaxed) / 1e6;
+	stats.blockedMs = mBlockedNs / 1e6;
+	stats.packets = mExecuted.exchange(0, std::memory_order_relaxed);
+	mBlockedNs = 0;
+
+	mTotal.submitMs += stats.submitMs;
+	mTotal.presentMs += stats.presentMs;
+	mTotal.blockedMs += stats.blockedMs;
+	mTotal.packets += stats.packets;
+
+	return stats;
+}
+
+void SubmissionThread::threadLoop()
+{
+	Profiler::Get().SetThreadName("Submission thread");
+
+	while (true)
+	{
+		uint32_t tail = mTail.load(std::memory_order_relaxed);
+
+		if (tail == mHead.load(std::memory_order_acquire))
+		{
+			std::unique_lock<std::mutex> lock(mWakeMutex);
+			mWake.wait(lock, [this, tail] { return tail != mHead.load(std::memory_order_acquire) || !mRunning; });
+
+			if (tail == mHead.load(std::memory_order_acquire))
+				return;
+		}
+
+		execute(mPackets[tail % Capacity]);
+
+		mTail.store(tail + 1, std::memory_order_release);
+		mExecuted.fetch_add(1, std::memory_order_relaxed);
+
+		{
+			std::lock_guard<std::mutex> lock(mWakeMutex);
+		}
+		mSpace.notify_one();
+	}
+}
+
+void SubmissionThread::execute(QueuePacket& packet)
+{
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point start = Clock::now();
+	VkResult result = VK_SUCCESS;
+
+	switch (packet.type)
+	{
+	case QueuePacketType::Submit:
+	{
+		PROFILE_ZONE("vkQueueSubmit");
+
+		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.waitSemaphoreCount = packet.waitSemaphoreCount;
+		submitInfo.pWaitSemaphores = packet.waitSemaphores;
+		submitInfo.pWaitDstStageMask = packet.waitStages;
+		submitInfo.commandBufferCount = packet.commandBufferCount;
+		submitInfo.pCommandBuffers = packet.commandBuffers;
+		submitInfo.signalSemaphoreCount = packet.signalSemaphoreCount;
+		submitInfo.pSignalSemaphores = packet.signalSemaphores;
+
+		VkTimelineSemaphoreSubmitInfoKHR timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR };
+		if (packet.timeline)
+		{
+			timelineInfo.waitSemaphoreValueCount = packet.waitSemaphoreCount;
+			timelineInfo.pWaitSemaphoreValues = packet.waitValues;
+			timelineInfo.signalSemaphoreValueCount = packet.signalSemaphoreCount;
+			timelineInfo.pSignalSemaphoreValues = packet.signalValues;
+			submitInfo.pNext = &timelineInfo;
+		}
+
+		result = vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, packet.fence);
+
+		// Reported to the producer on its next submit or present, like the synchronous path would have thrown.
+		if (result != VK_SUCCESS)
+		{
+			mSubmitErrorName.store(packet.name, std::memory_order_relaxed);
+			mSubmitError.store(result, std::memory_order_release);
+		}
+
+		mSubmitNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(), std::memory_order_relaxed);
+		break;
+	}
+	case QueuePacketType::Present:
+	{
+		PROFILE_ZONE("vkQueuePresentKHR");
+
+		VkPresentInfoKHR presentInfo{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+		presentInfo.waitSemaphoreCount = packet.waitSemaphoreCount;
+		presentInfo.pWaitSemaphores = packet.waitSemaphores;
+		presentInfo.swapchainCount = 1;
+		presentInfo.pSwapchains = &packet.swapChain;
+		presentInfo.pImageIndices = &packet.imageIndex;
+
+		{
+			std::lock_guard<std::mutex> lock(mSwapChainMutex);
+			result = vkQueuePresentKHR(mPresentQueue, &presentInfo);
+		}
+
+		if (result != VK_SUCCESS)
+			mPresentResult.store(result, std::memory_order_release);
+
+		mPresentNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(), std::memory_order_relaxed);
+		break;
+	}
+	case QueuePacketType::Flush:
+		break;
+	}
+
+	if (packet.completion)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mCompletionMutex);
+			packet.completion->done = true;
+		}
+
+		mCompleted.notify_all();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#ifndef SUBMISSIONTHREAD_H
+#define SUBMISSIONTHREAD_H
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+enum class QueuePacketType : uint32_t
+{
+	Submit,
+	Present,
+	Flush
+};
+
+// A blocking request waits on one of these, which lives on the caller's stack.
+struct QueueCompletion
+{
+	bool done = false;
+};
+
+// Everything vkQueueSubmit or vkQueuePresentKHR needs, copied so the caller's arrays can go.
+struct QueuePacket
+{
+	static const uint32_t MaxSemaphores = 4;
+	static const uint32_t MaxCommandBuffers = 4;
+
+	QueuePacketType type = QueuePacketType::Submit;
+
+	uint32_t waitSemaphoreCount = 0;
+	VkSemaphore waitSemaphores[MaxSemaphores] = {};
+	VkPipelineStageFlags waitStages[MaxSemaphores] = {};
+	uint32_t commandBufferCount = 0;
+	VkCommandBuffer commandBuffers[MaxCommandBuffers] = {};
+	uint32_t signalSemaphoreCount = 0;
+	VkSemaphore signalSemaphores[MaxSemaphores] = {};
+	VkFence fence = VK_NULL_HANDLE;
+
+	// From a VkTimelineSemaphoreSubmitInfoKHR in the submit's chain, if it had one.
+	bool timeline = false;
+	uint64_t waitValues[MaxSemaphores] = {};
+	uint64_t signalValues[MaxSemaphores] = {};
+
+	VkSwapchainKHR swapChain = VK_NULL_HANDLE;
+	uint32_t imageIndex = 0;
+
+	// What a failed submit is reported as.
+	const char* name = nullptr;
+
+	QueueCompletion* completion = nullptr;
+};
+
+struct SubmissionStats
+{
+	double submitMs = 0.0;
+	double presentMs = 0.0;
+	// Time the producer itself waited: on a full ring, or for a flush to come back.
+	double blockedMs = 0.0;
+	uint64_t packets = 0;
+};
+
+// Owns the graphics and present queues while it runs. One producing thread at a time pushes packets into a lock-free
+// ring; this thread makes the driver calls in order, so recording threads do not block on them. Completion is waited
+// on through the queue's timeline. Present results come back on the next frame. Time spent inside the queue calls is
+// accumulated apart from the time the producer was blocked on this thread.
+class SubmissionThread
+{
+public:
+	static const uint32_t Capacity = 64;
+
+	~SubmissionThread();
+
+	void Start(VkDevice device, VkQueue graphicsQueue, VkQueue presentQueue);
+	// Executes what is still queued, then joins. The queues belong to the caller again afterwards.
+	void Stop();
+
+	bool IsRunning() const { return mThread.joinable(); }
+
+	// Name describes the submission in the error a failure is reported with.
+	void Submit(const VkSubmitInfo& submitInfo, VkFence fence, const char* name);
+	void Present(VkSwapchainKHR swapChain, uint32_t imageIndex, VkSemaphore waitSemaphore);
+
+	// Called on the producer rather than queued, so it does not wait for the previous frame's submit and present to
+	// be handed over first. Only the present call itself is excluded, which is what the swap chain requires.
+	VkResult AcquireNextImage(VkSwapchainKHR swapChain, VkSemaphore semaphore, uint32_t& imageIndex);
+	// Waits until everything pushed so far was handed to the driver, e.g. before the swap chain is recreated. Does not
+	// report failed submits, so it is safe from Stop and destructors.
+	void Flush();
+
+	// Throws for a submit that failed since the last check. Submit and Present check on their own, so this is only
+	// needed before waiting on a submission that was just pushed.
+	void CheckSubmitError();
+
+	// Result of the most recent present that did not succeed cleanly, or VK_SUCCESS. Resets it.
+	VkResult TakePresentResult() { return mPresentResult.exchange(VK_SUCCESS, std::memory_order_acq_rel); }
+
+	// Time in queue calls and time the producer was blocked since the last call, and totals since Start.
+	SubmissionStats TakeFrameStats();
+	SubmissionStats GetTotalStats() const { return mTotal; }
+private:
+	void push(const QueuePacket& packet);
+	void wait(QueueCompletion& completion);
+	void threadLoop();
+	void execute(QueuePacket& packet);
+
+	VkDevice mDevice = VK_NULL_HANDLE;
+	VkQueue mGraphicsQueue = VK_NULL_HANDLE;
+	VkQueue mPresentQueue = VK_NULL_HANDLE;
+
+	std::unique_ptr<QueuePacket[]> mPackets{ new QueuePacket[Capacity] };
+	alignas(64) std::atomic<uint32_t> mHead{ 0 };
+	alignas(64) std::atomic<uint32_t> mTail{ 0 };
+
+	std::thread mThread;
+	std::atomic<bool> mRunning{ false };
+	std::mutex mWakeMutex;
+	std::condition_variable mWake;
+	std::condition_variable mSpace;
+
+	std::mutex mCompletionMutex;
+	std::condition_variable mCompleted;
+
+	// Acquire and present both need external synchronization on the swap chain.
+	std::mutex mSwapChainMutex;
+
+	std::atomic<VkResult> mPresentResult{ VK_SUCCESS };
+	std::atomic<int32_t> mSubmitError{ VK_SUCCESS };
+	std::atomic<const char*> mSubmitErrorName{ nullptr };
+
+	// Written by the submission thread, read by the producer through TakeFrameStats.
+	std::atomic<int64_t> mSubmitNs{ 0 };
+	std::atomic<int64_t> mPresentNs{ 0 };
+	std::atomic<uint64_t> mExecuted{ 0 };
+	// Only touched by the producer.
+	int64_t mBlockedNs = 0;
+	SubmissionStats mTotal;
+};
+
+#endif
\ No newline at end of file
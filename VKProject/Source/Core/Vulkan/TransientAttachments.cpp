@@ -0,0 +1,165 @@
+#include "TransientAttachments.h"
+
+#include <Core/Vulkan/MemoryTracker.h>
+
+#include <algorithm>
+#include <iostream>
+
+void TransientAttachmentAllocator::Add(VkImage image, const std::string& tag, uint32_t firstPass, uint32_t lastPass)
+{
+	TransientAttachment attachment;
+	attachment.tag = tag;
+	attachment.image = image;
+	attachment.firstPass = firstPass;
+	attachment.lastPass = lastPass;
+
+	vkGetImageMemoryRequirements(mDevice, image, &attachment.memReq);
+
+	mPending.push_back(attachment);
+}
+
+bool TransientAttachmentAllocator::overlaps(const Slot& slot, const TransientAttachment& attachment) const
+{
+	for (size_t member : slot.members)
+	{
+		const auto& other = mAttachments[member];
+		if (attachment.firstPass <= other.lastPass && other.firstPass <= attachment.lastPass)
+			return true;
+	}
+
+	return false;
+}
+
+void TransientAttachmentAllocator::Allocate()
+{
+	// The images of the previous batch have already been replaced by their owners.
+	mMemory.clear();
+	mSlots.clear();
+	mAttachments = std::move(mPending);
+	mPending.clear();
+
+	std::vector<size_t> order(mAttachments.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return mAttachments[a].memReq.size > mAttachments[b].memReq.size; });
+
+	for (size_t index : order)
+	{
+		auto& attachment = mAttachments[index];
+		bool placed = false;
+
+		for (uint32_t i = 0; i < mSlots.size() && !placed; i++)
+		{
+			auto& slot = mSlots[i];
+			if ((slot.memoryTypeBits & attachment.memReq.memoryTypeBits) == 0 || overlaps(slot, attachment))
+				continue;
+
+			slot.size = std::max(slot.size, attachment.memReq.size);
+			slot.alignment = std::max(slot.alignment, attachment.memReq.alignment);
+			slot.memoryTypeBits &= attachment.memReq.memoryTypeBits;
+			slot.members.push_back(index);
+			attachment.slot = i;
+			placed = true;
+		}
+
+		if (!placed)
+		{
+			Slot slot;
+			slot.size = attachment.memReq.size;
+			slot.alignment = attachment.memReq.alignment;
+			slot.memoryTypeBits = attachment.memReq.memoryTypeBits;
+			slot.members.push_back(index);
+			attachment.slot = static_cast<uint32_t>(mSlots.size());
+			mSlots.push_back(slot);
+		}
+	}
+
+	mMemory.resize(mSlots.size());
+	mLazy = !mSlots.empty();
+
+	auto& tracker = MemoryTracker::Get();
+
+	for (size_t i = 0; i < mSlots.size(); i++)
+	{
+		const auto& slot = mSlots[i];
+
+		VkMemoryPropertyFlags props = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+		if (!tracker.HasMemoryType(slot.memoryTypeBits, props))
+		{
+			props = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			mLazy = false;
+		}
+
+		VkMemoryAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+		allocInfo.allocationSize = slot.size;
+		allocInfo.memoryTypeIndex = tracker.FindMemoryType(slot.memoryTypeBits, props, slot.size);
+
+		if (vkAllocateMemory(mDevice, &allocInfo, HostAllocator::Get().Callbacks(), mMemory[i].replace(mDevice)) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate transient attachment memory!");
+
+		std::string tag = "Transient";
+		for (size_t member : slot.members)
+		{
+			const auto& attachment = mAttachments[member];
+
+			vkBindImageMemory(mDevice, attachment.image, mMemory[i], 0);
+			tracker.TrackImage(attachment.image, attachment.tag, attachment.memReq.size, allocInfo.memoryTypeIndex);
+
+			tag += " " + attachment.tag;
+		}
+
+		tracker.TrackMemory(mMemory[i], tag, allocInfo.allocationSize, allocInfo.memoryTypeIndex);
+	}
+}
+
+void TransientAttachmentAllocator::Retire(DeletionQueue& queue, uint64_t value)
+{
+	for (auto& memory : mMemory)
+		queue.Push<FreeTrackedMemory>(value, mDevice, memory.release());
+
+	mMemory.clear();
+	mSlots.clear();
+	mAttachments.clear();
+}
+
+VkDeviceSize TransientAttachmentAllocator::GetRequestedBytes() const
+{
+	VkDeviceSize total = 0;
+	for (const auto& attachment : mAttachments)
+		total += attachment.memReq.size;
+
+	return total;
+}
+
+VkDeviceSize TransientAttachmentAllocator::GetAllocatedBytes() const
+{
+	VkDeviceSize total = 0;
+	for (const auto& slot : mSlots)
+		total += slot.size;
+
+	return total;
+}
+
+void TransientAttachmentAllocator::PrintReport(VkExtent2D extent, VkSampleCountFlagBits samples)
+{
+	VkDeviceSize requested = GetRequestedBytes();
+	VkDeviceSize allocated = GetAllocatedBytes();
+
+	VkDeviceSize committed = 0;
+	for (const auto& memory : mMemory)
+	{
+		VkDeviceSize bytes = 0;
+		if (mLazy)
+			vkGetDeviceMemoryCommitment(mDevice, memory, &bytes);
+
+		committed += bytes;
+	}
+
+	const float mb = 1024.0f * 1024.0f;
+
+	std::cout << "Transient attachments " << extent.width << "x" << extent.height << " MSAA x" << samples << ": "
+		<< mAttachments.size() << " images in " << mSlots.size() << " allocations, "
+		<< requested / mb << "Mb requested, " << allocated / mb << "Mb allocated (aliasing saved " << (requested - allocated) / mb << "Mb), "
+		<< (mLazy ? "lazily allocated, " + std::to_string(committed / mb) + "Mb committed" : "lazily allocated memory unavailable") << '\n';
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef TRANSIENTATTACHMENTS_H
+#define TRANSIENTATTACHMENTS_H
+
+#include <Core/Vulkan/VkHandle.h>
+#include <Core/Vulkan/DeletionQueue.h>
+#include <Core/Vulkan/MemoryTracker.h>
+
+#include <string>
+#include <vector>
+
+struct TransientAttachment
+{
+	std::string tag;
+	VkImage image = VK_NULL_HANDLE;
+	VkMemoryRequirements memReq{};
+	uint32_t firstPass = 0;
+	uint32_t lastPass = 0;
+	uint32_t slot = 0;
+};
+
+// Backs attachments that only live inside render passes. Memory prefers LAZILY_ALLOCATED types,
+// and attachments whose [firstPass, lastPass] ranges do not overlap share (alias) the same memory.
+class TransientAttachmentAllocator
+{
+public:
+	TransientAttachmentAllocator(const DeviceHandle& device) : mDevice(device) {}
+
+	void Add(VkImage image, const std::string& tag, uint32_t firstPass, uint32_t lastPass);
+	void Allocate();
+	// Hands the current memory to the deletion queue instead of freeing it, for images that frames in flight still use.
+	void Retire(DeletionQueue& queue, uint64_t value);
+
+	void PrintReport(VkExtent2D extent, VkSampleCountFlagBits samples);
+
+	VkDeviceSize GetRequestedBytes() const;
+	VkDeviceSize GetAllocatedBytes() const;
+	bool IsLazilyAllocated() const { return mLazy; }
+private:
+	struct Slot
+	{
+		VkDeviceSize size = 0;
+		VkDeviceSize alignment = 1;
+		uint32_t memoryTypeBits = ~0u;
+		std::vector<size_t> members;
+	};
+
+	bool overlaps(const Slot& slot, const TransientAttachment& attachment) const;
+
+	const DeviceHandle& mDevice;
+
+	std::vector<TransientAttachment> mPending;
+	std::vector<TransientAttachment> mAttachments;
+	std::vector<Slot> mSlots;
+	std::vector<VkHandle<VkDeviceMemory, FreeTrackedMemory>> mMemory;
+
+	bool mLazy = false;
+};
+
+#endif
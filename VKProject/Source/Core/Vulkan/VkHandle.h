@@ -0,0 +1,119 @@
+#pragma once
+
+#ifndef VKHANDLE_H
+#define VKHANDLE_H
+
+#include <vulkan/vulkan.h>
+
+#include <Core/Vulkan/HostAllocator.h>
+
+#include <memory>
+#include <type_traits>
+
+// What a handle is destroyed through, read off the destroy function's parameters: VkDevice, VkInstance, or nothing
+// for the instance and the device themselves.
+template <class T, auto Destroy>
+using VkHandleParent = std::conditional_t<std::is_invocable_v<decltype(Destroy), VkDevice, T, const VkAllocationCallbacks*>, VkDevice,
+	std::conditional_t<std::is_invocable_v<decltype(Destroy), VkInstance, T, const VkAllocationCallbacks*>, VkInstance, void>>;
+
+template <class Parent>
+struct VkHandleStorage
+{
+	Parent parent = VK_NULL_HANDLE;
+
+	template <auto Destroy, class T>
+	void destroy(T object) const { Destroy(parent, object, HostAllocator::Get().Callbacks()); }
+};
+
+// Empty, so parentless handles are no bigger than the handle.
+template <>
+struct VkHandleStorage<void>
+{
+	template <auto Destroy, class T>
+	void destroy(T object) const { Destroy(object, HostAllocator::Get().Callbacks()); }
+};
+
+// Owns a Vulkan handle. The destroy function is a template parameter, so destruction is a direct call and the
+// wrapper holds nothing but the handle and the raw parent it is destroyed through. The parent is passed in when the
+// handle is created, since members are constructed long before their device exists. Move only.
+template <class T, auto Destroy>
+class VkHandle : private VkHandleStorage<VkHandleParent<T, Destroy>>
+{
+public:
+	using Parent = VkHandleParent<T, Destroy>;
+
+	VkHandle() = default;
+	~VkHandle() { cleanup(); }
+
+	VkHandle(const VkHandle&) = delete;
+	VkHandle& operator=(const VkHandle&) = delete;
+
+	VkHandle(VkHandle&& other) noexcept : Storage(other), mObject(other.release()) {}
+
+	VkHandle& operator=(VkHandle&& other) noexcept
+	{
+		if (this != std::addressof(other))
+		{
+			cleanup();
+			Storage::operator=(other);
+			mObject = other.release();
+		}
+
+		return *this;
+	}
+
+	const T* operator &() const { return &mObject; }
+	operator T() const { return mObject; }
+
+	// Destroys the current handle and returns where a vkCreate* call writes the new one. The parent parameter is not
+	// deduced, so the application's device or instance wrapper converts to the raw handle.
+	template <class P = Parent>
+	T* replace(std::enable_if_t<!std::is_void_v<P>, P> parent)
+	{
+		cleanup();
+		this->parent = parent;
+		return &mObject;
+	}
+
+	template <class P = Parent, std::enable_if_t<std::is_void_v<P>, int> = 0>
+	T* replace()
+	{
+		cleanup();
+		return &mObject;
+	}
+
+	// Takes over a handle created elsewhere.
+	template <class P = Parent>
+	void reset(std::enable_if_t<!std::is_void_v<P>, P> parent, T object)
+	{
+		*replace(parent) = object;
+	}
+
+	// Hands the handle over to the caller, who becomes responsible for destroying it.
+	T release()
+	{
+		T released = mObject;
+		mObject = VK_NULL_HANDLE;
+		return released;
+	}
+
+	template <typename V>
+	bool operator==(V rhs) const { return mObject == T(rhs); }
+private:
+	using Storage = VkHandleStorage<Parent>;
+
+	void cleanup()
+	{
+		if (mObject != VK_NULL_HANDLE)
+			this->template destroy<Destroy>(mObject);
+
+		mObject = VK_NULL_HANDLE;
+	}
+
+	T mObject = VK_NULL_HANDLE;
+};
+
+// Helpers that are created before the device keep a reference to the application's handle.
+using DeviceHandle = VkHandle<VkDevice, vkDestroyDevice>;
+
+#endif
\ No newline at end of file
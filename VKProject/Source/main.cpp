@@ -1,10 +1,60 @@
 #include <iostream>
 
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
 #include "Core/Application.h"
+#include "Core/Jobs/JobBenchmark.h"
+#include "Core/Vulkan/HandleBenchmark.h"
+#include "Core/Profiling/ProfilerBenchmark.h"
 
-int main()
+int main(int argc, char** argv)
 {
-	Application* app = new Application;
+	std::map<std::string, uint32_t> overrides;
+	std::map<std::string, std::string> files;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--bench-jobs") == 0)
+			return JobBenchmark::Run();
+
+		if (std::strcmp(argv[i], "--bench-zones") == 0)
+			return ProfilerBenchmark::Run();
+
+		if (std::strcmp(argv[i], "--bench-handles") == 0)
+			return HandleBenchmark::Run();
+
+		// --headless [frames] renders offscreen without a window, e.g. on CI with lavapipe.
+		if (std::strcmp(argv[i], "--headless") == 0)
+		{
+			overrides["HEADLESS"] = 1;
+
+			if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+				overrides["HEADLESS_FRAMES"] = static_cast<uint32_t>(std::atoi(argv[++i]));
+		}
+
+		// --benchmark [camera path] replays a camera path and writes benchmark_report.json/.csv. Combines with --headless.
+		if (std::strcmp(argv[i], "--benchmark") == 0)
+		{
+			overrides["BENCHMARK"] = 1;
+
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				files["CAMERA_PATH"] = argv[++i];
+		}
+
+		// --record <file> captures keyboard and mouse input; --replay <file> runs it back as a benchmark.
+		if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+			files["RECORD_INPUT"] = argv[++i];
+
+		if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+			files["REPLAY_INPUT"] = argv[++i];
+
+		if (std::strcmp(argv[i], "--benchmark-frames") == 0 && i + 1 < argc)
+			overrides["BENCHMARK_FRAMES"] = static_cast<uint32_t>(std::atoi(argv[++i]));
+	}
+
+	Application* app = new Application(overrides, files);
 
 	try
 	{